@@ -13,9 +13,348 @@
 #include <condition_variable>
 #include <queue>
 #include <atomic>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <map>
+#include <climits>
+#include <limits>
+#include <memory>
+#include <random>
+#include <new>
+#include <cstdlib>
+#include <cstdarg>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 constexpr double PI = 3.14159265358979323846;
 
+// Heap allocation counters. Global operator new/delete are replaced so every
+// allocation made by this program (any thread; not those inside the SFML
+// libraries when they are linked as DLLs) is counted, and the frame loop
+// reports the per-frame deltas. The steady-state interactive frame is meant
+// to allocate nothing; these counters are how that is checked.
+std::atomic<uint64_t> g_heapAllocs(0);
+std::atomic<uint64_t> g_heapBytes(0);
+
+inline void *countedAlloc(size_t bytes) {
+    g_heapAllocs.fetch_add(1, std::memory_order_relaxed);
+    g_heapBytes.fetch_add(bytes, std::memory_order_relaxed);
+    return std::malloc(bytes ? bytes : 1);
+}
+
+void *operator new(size_t bytes) {
+    void *p = countedAlloc(bytes);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void *operator new[](size_t bytes) {
+    void *p = countedAlloc(bytes);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void *operator new(size_t bytes, const std::nothrow_t &) noexcept { return countedAlloc(bytes); }
+void *operator new[](size_t bytes, const std::nothrow_t &) noexcept { return countedAlloc(bytes); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { std::free(p); }
+
+// Per-frame bump allocator for the main loop's transient data (overlay and
+// log formatting). reset() at the start of a frame releases everything at
+// once. A frame that needs more than the block spills into overflow chunks,
+// and the next reset() grows the block to the high-water mark, so after
+// warm-up frames take no heap allocations at all. Only trivially
+// destructible data belongs here; nothing is destroyed on reset.
+struct FrameArena {
+    std::unique_ptr<uint8_t[]> block;
+    size_t capacity = 0, used = 0, highWater = 0;
+    std::vector<std::unique_ptr<uint8_t[]>> overflow;
+    uint64_t overflows = 0; // frames that spilled
+
+    explicit FrameArena(size_t bytes) : block(new uint8_t[bytes]), capacity(bytes) { overflow.reserve(16); }
+
+    void *allocate(size_t bytes, size_t align = alignof(double)) {
+        size_t at = (used + align - 1) & ~(align - 1);
+        used = at + bytes;
+        highWater = std::max(highWater, used);
+        if (used <= capacity) return block.get() + at;
+        overflow.emplace_back(new uint8_t[bytes]);
+        return overflow.back().get();
+    }
+    template <class T> T *alloc(size_t n) { return static_cast<T *>(allocate(n * sizeof(T), alignof(T))); }
+
+    void reset() {
+        if (!overflow.empty()) {
+            ++overflows;
+            overflow.clear();
+            capacity = highWater + highWater / 2;
+            block.reset(new uint8_t[capacity]);
+        }
+        used = 0;
+    }
+};
+
+// printf-style text built in a FrameArena buffer (truncates at capacity)
+struct ArenaText {
+    char *buf;
+    size_t cap, len = 0;
+    ArenaText(FrameArena &arena, size_t capacity) : buf(arena.alloc<char>(capacity)), cap(capacity) { buf[0] = '\0'; }
+    void printf(const char *fmt, ...) {
+        if (len + 1 >= cap) return;
+        va_list args;
+        va_start(args, fmt);
+        int n = std::vsnprintf(buf + len, cap - len, fmt, args);
+        va_end(args);
+        if (n > 0) len = std::min(cap - 1, len + static_cast<size_t>(n));
+    }
+    const char *c_str() const { return buf; }
+};
+
+// Persistent worker threads for the parallel renderers, so a frame does not
+// create threads (each costs a heap allocation and a kernel call). run(n, f)
+// calls f(0..n-1) across the workers and the calling thread and returns when
+// all are done. Concurrent batches (the UI thread while the precache thread
+// renders a keyframe) share the workers through a job queue; workers serve
+// the newest batch first, so a UI render started during a long background
+// batch still gets the whole pool. Calls from a worker run inline.
+class WorkerPool {
+public:
+    static WorkerPool &shared() {
+        static WorkerPool pool(std::max(1, static_cast<int>(std::thread::hardware_concurrency())) - 1);
+        return pool;
+    }
+    int size() const { return static_cast<int>(workers.size()) + 1; }
+
+    template <class F> void run(int jobs, F &f) {
+        if (jobs <= 1 || workers.empty() || isWorker()) {
+            for (int i = 0; i < jobs; ++i) f(i);
+            return;
+        }
+        Batch batch;
+        batch.task = &invoke<F>;
+        batch.context = &f;
+        batch.total = jobs;
+        std::unique_lock<std::mutex> lk(m);
+        batches.push_back(&batch);
+        wake.notify_all();
+        // the caller works on its own batch, then waits for jobs the workers took
+        while (batch.next < batch.total) {
+            const int i = batch.next++;
+            lk.unlock();
+            batch.task(batch.context, i);
+            lk.lock();
+            ++batch.done;
+        }
+        batches.erase(std::find(batches.begin(), batches.end(), &batch));
+        finished.wait(lk, [&] { return batch.done == batch.total; });
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &t : workers) t.join();
+    }
+
+private:
+    // one run() call; lives on the caller's stack until all its jobs are done
+    struct Batch {
+        void (*task)(void *, int) = nullptr;
+        void *context = nullptr;
+        int total = 0, next = 0, done = 0; // guarded by m
+    };
+
+    explicit WorkerPool(int threads) {
+        batches.reserve(16);
+        for (int i = 0; i < threads; ++i) workers.emplace_back([this] { loop(); });
+    }
+    template <class F> static void invoke(void *f, int i) { (*static_cast<F *>(f))(i); }
+    static bool &isWorker() {
+        static thread_local bool worker = false;
+        return worker;
+    }
+    // newest batch that still has unclaimed jobs
+    Batch *claimable() const {
+        for (size_t k = batches.size(); k-- > 0;) {
+            if (batches[k]->next < batches[k]->total) return batches[k];
+        }
+        return nullptr;
+    }
+    void loop() {
+        isWorker() = true;
+        std::unique_lock<std::mutex> lk(m);
+        while (true) {
+            wake.wait(lk, [&] { return stopping || claimable(); });
+            if (stopping) return;
+            Batch *b = claimable();
+            const int i = b->next++;
+            lk.unlock();
+            b->task(b->context, i);
+            lk.lock();
+            if (++b->done == b->total) finished.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex m;
+    std::condition_variable wake, finished;
+    std::vector<Batch *> batches; // running batches, oldest first
+    bool stopping = false;
+};
+
+// One long-lived thread that runs a job on request, one run at a time. Work
+// that is restarted on every wheel step (zoom completion, precache) reuses
+// the thread, and with it the thread's render scratch, instead of starting a
+// thread per run. The job polls cancelled() and returns early when it is set.
+class BackgroundTask {
+public:
+    BackgroundTask(void (*job)(void *), void *context) : job(job), context(context) {}
+    BackgroundTask(const BackgroundTask &) = delete;
+    BackgroundTask &operator=(const BackgroundTask &) = delete;
+    ~BackgroundTask() {
+        cancel();
+        {
+            std::lock_guard<std::mutex> lk(m);
+            stopping = true;
+        }
+        wake.notify_one();
+        if (worker.joinable()) worker.join();
+    }
+
+    // Run the job again; a pending or running run is cancelled first
+    void start() {
+        cancel();
+        std::lock_guard<std::mutex> lk(m);
+        pending = true;
+        if (!worker.joinable()) worker = std::thread([this] { loop(); });
+        wake.notify_one();
+    }
+    // Drop a pending run and wait for a running one to return
+    void cancel() {
+        std::unique_lock<std::mutex> lk(m);
+        pending = false;
+        stopRun = running;
+        idle.wait(lk, [&] { return !running; });
+        stopRun = false;
+    }
+    bool busy() const {
+        std::lock_guard<std::mutex> lk(m);
+        return pending || running;
+    }
+    bool cancelled() const { return stopRun; }
+
+private:
+    void loop() {
+        std::unique_lock<std::mutex> lk(m);
+        while (true) {
+            wake.wait(lk, [&] { return stopping || pending; });
+            if (stopping) return;
+            pending = false;
+            running = true;
+            lk.unlock();
+            job(context);
+            lk.lock();
+            running = false;
+            idle.notify_all();
+        }
+    }
+
+    void (*job)(void *);
+    void *context;
+    mutable std::mutex m;
+    std::condition_variable wake, idle;
+    bool pending = false, running = false, stopping = false; // guarded by m
+    std::atomic<bool> stopRun{false};
+    std::thread worker;
+};
+
+// Reset `image` to width x height of `color`. sf::Image::create always
+// allocates a fresh pixel buffer, so it is only used when the size changes.
+inline void clearImage(sf::Image &image, int width, int height, const sf::Color &color) {
+    if (image.getSize().x != static_cast<unsigned>(width) || image.getSize().y != static_cast<unsigned>(height)) {
+        image.create(width, height, color);
+        return;
+    }
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) image.setPixel(x, y, color);
+    }
+}
+
+enum FractalType { MADELBROT = 1, SIERPINSKI = 2, KOCH = 3, MENGER = 4, DRAGON = 5,
+                   JULIA = 6, MULTIBROT3 = 7, BURNING_SHIP = 8, BUDDHABROT = 9 };
+const int FRACTAL_COUNT = 9;
+
+// Log-bucketed latency histogram (HDR-style): 16 linear sub-buckets per power
+// of two of microseconds, i.e. ~6% resolution from 1 us up to ~30 minutes.
+// record() is one relaxed atomic increment, so the hot path never locks and
+// any thread may record; percentiles are read from the bucket midpoints.
+struct LatencyHistogram {
+    static const int SUB_BITS = 4;
+    static const int SUB = 1 << SUB_BITS;
+    static const int BUCKETS = (31 - SUB_BITS + 1) * SUB;
+    std::atomic<uint32_t> counts[BUCKETS];
+
+    LatencyHistogram() { reset(); }
+    static int bucketOf(uint64_t us) {
+        if (us < static_cast<uint64_t>(SUB)) return static_cast<int>(us);
+        int msb = 63;
+        while (!(us >> msb)) --msb;
+        int idx = (msb - SUB_BITS + 1) * SUB + static_cast<int>((us >> (msb - SUB_BITS)) & (SUB - 1));
+        return std::min(idx, BUCKETS - 1);
+    }
+    static double bucketMidUs(int idx) {
+        if (idx < SUB) return idx + 0.5;
+        int msb = idx / SUB + SUB_BITS - 1;
+        double width = static_cast<double>(1ull << (msb - SUB_BITS));
+        return (SUB + idx % SUB) * width + width / 2.0;
+    }
+    void record(double ms) {
+        uint64_t us = ms > 0.0 ? static_cast<uint64_t>(ms * 1000.0) : 0;
+        counts[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+    }
+    uint64_t count() const {
+        uint64_t n = 0;
+        for (int i = 0; i < BUCKETS; ++i) n += counts[i].load(std::memory_order_relaxed);
+        return n;
+    }
+    // q in [0,1]; 0 when empty
+    double percentileMs(double q) const {
+        uint64_t n = count();
+        if (!n) return 0.0;
+        uint64_t rank = static_cast<uint64_t>(std::ceil(q * n));
+        if (rank < 1) rank = 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            seen += counts[i].load(std::memory_order_relaxed);
+            if (seen >= rank) return bucketMidUs(i) / 1000.0;
+        }
+        return bucketMidUs(BUCKETS - 1) / 1000.0;
+    }
+    void reset() { for (int i = 0; i < BUCKETS; ++i) counts[i].store(0, std::memory_order_relaxed); }
+};
+
+// Latency distributions of the frame stages
+struct FrameLatency {
+    LatencyHistogram render, upload, display, frame;
+    void reset() { render.reset(); upload.reset(); display.reset(); frame.reset(); }
+};
+
 // Performance stats per-fractal
 struct PerfStats {
     uint64_t frames = 0;
@@ -29,6 +368,7 @@ struct PerfStats {
         if (ms > maxMs) maxMs = ms;
     }
     double avg() const { return frames ? (totalMs / static_cast<double>(frames)) : 0.0; }
+    FrameLatency latency;
 };
 
 // Interval stats for periodic summaries
@@ -43,24 +383,348 @@ struct IntervalStats {
         if (ms < minMs) minMs = ms;
         if (ms > maxMs) maxMs = ms;
     }
-    void reset() { frames = 0; totalMs = 0.0; minMs = 1e9; maxMs = 0.0; }
+    void reset() { frames = 0; totalMs = 0.0; minMs = 1e9; maxMs = 0.0; latency.reset(); }
     double avg() const { return frames ? (totalMs / static_cast<double>(frames)) : 0.0; }
+    FrameLatency latency;
 };
 
-// Function to calculate Mandelbrot set value for a point
-int calculateMandelbrot(double x, double y, int maxIter) {
-    std::complex<double> c(x, y);
-    std::complex<double> z(0, 0);
-    
-    for (int i = 0; i < maxIter; ++i) {
-        z = z * z + c;
-        if (std::abs(z) > 2.0) {
-            return i;
+// Double-double real (~106-bit mantissa): an unevaluated sum hi + lo with
+// |lo| <= ulp(hi)/2. Products use Dekker splitting rather than std::fma,
+// which is emulated in software on CPUs without FMA.
+struct DD {
+    double hi = 0.0, lo = 0.0;
+    DD() {}
+    DD(double h) : hi(h), lo(0.0) {}
+    DD(double h, double l) : hi(h), lo(l) {}
+    double toDouble() const { return hi + lo; }
+};
+
+inline DD ddTwoSum(double a, double b) {
+    double s = a + b;
+    double bb = s - a;
+    return DD(s, (a - (s - bb)) + (b - bb));
+}
+inline DD ddQuickTwoSum(double a, double b) {
+    double s = a + b;
+    return DD(s, b - (s - a));
+}
+inline void ddSplit(double a, double &hi, double &lo) {
+    double t = 134217729.0 * a; // 2^27 + 1
+    hi = t - (t - a);
+    lo = a - hi;
+}
+inline DD ddTwoProd(double a, double b) {
+    double p = a * b, ah, al, bh, bl;
+    ddSplit(a, ah, al);
+    ddSplit(b, bh, bl);
+    return DD(p, ((ah * bh - p) + ah * bl + al * bh) + al * bl);
+}
+inline DD operator+(const DD &a, const DD &b) {
+    DD s = ddTwoSum(a.hi, b.hi);
+    DD t = ddTwoSum(a.lo, b.lo);
+    s = ddQuickTwoSum(s.hi, s.lo + t.hi);
+    return ddQuickTwoSum(s.hi, s.lo + t.lo);
+}
+inline DD operator-(const DD &a) { return DD(-a.hi, -a.lo); }
+inline DD operator-(const DD &a, const DD &b) { return a + (-b); }
+inline DD operator*(const DD &a, const DD &b) {
+    DD p = ddTwoProd(a.hi, b.hi);
+    return ddQuickTwoSum(p.hi, p.lo + (a.hi * b.lo + a.lo * b.hi));
+}
+inline DD operator*(double a, const DD &b) { return DD(a) * b; }
+inline DD fabs(const DD &a) { return a.hi < 0.0 ? -a : a; }
+
+// Numeric precision of the escape-time kernels, picked per frame from the
+// pixel spacing: float32 while its rounding stays well below a pixel (twice
+// the SIMD lanes of double), then double, then double-double. Spacing is
+// measured against the escape radius 2, the largest coordinate that matters,
+// so tiles and frames with the same spacing always use the same tier.
+// Double-double resolves pixels down to about 1e-30, i.e. zooms of about 1e28.
+enum PrecisionTier { TIER_FLOAT = 0, TIER_DOUBLE = 1, TIER_DOUBLE_DOUBLE = 2 };
+
+inline const char *precisionTierName(int tier) {
+    return tier == TIER_FLOAT ? "float32" : (tier == TIER_DOUBLE ? "double" : "double-double");
+}
+
+inline PrecisionTier selectPrecisionTier(double spacing) {
+    const double rel = spacing / 2.0;
+    if (rel > 1e-5) return TIER_FLOAT;   // float eps 1.2e-7: ~100x headroom for iteration error
+    if (rel > 1e-13) return TIER_DOUBLE; // double eps 2.2e-16: ~500x headroom
+    return TIER_DOUBLE_DOUBLE;
+}
+
+// Per-frame parameters of the escape-time renderers. View bounds handed to
+// renderers are relative to the double-double origin, so deep zooms keep their
+// precision in the bounds; Julia uses a fixed c.
+struct FractalParams {
+    double juliaRe = -0.8;
+    double juliaIm = 0.156;
+    DD originR, originI;
+    bool antialias = false; // adaptive supersampling of high-variance pixels (A, --antialias)
+};
+
+// Cumulative renderer counters; callers diff them per frame
+struct RenderStats {
+    uint64_t basePixels = 0; // one sample per pixel in the base pass
+    uint64_t aaPixels = 0;   // pixels the antialiasing pass refined
+    uint64_t aaSamples = 0;  // extra sub-pixel samples it computed
+};
+
+// Escape-time formulas. Each is a policy type with a static step(); the
+// kernels below are templates over the formula and the scalar type, so every
+// fractal and precision gets its own compiled inner loop and there is no
+// per-pixel dispatch.
+struct MandelbrotFormula {
+    template <class T> static void step(T &zr, T &zi, T cr, T ci) {
+        T r2 = zr * zr, i2 = zi * zi;
+        zi = 2 * zr * zi + ci;
+        zr = r2 - i2 + cr;
+    }
+};
+
+// z^Power + c, with the power unrolled at compile time
+template <int Power> struct MultibrotFormula {
+    template <class T> static void step(T &zr, T &zi, T cr, T ci) {
+        T pr = zr, pi = zi;
+        for (int k = 1; k < Power; ++k) {
+            T nr = pr * zr - pi * zi;
+            pi = pr * zi + pi * zr;
+            pr = nr;
         }
+        zr = pr + cr;
+        zi = pi + ci;
+    }
+};
+
+// (|Re z| + i|Im z|)^2 + c
+struct BurningShipFormula {
+    template <class T> static void step(T &zr, T &zi, T cr, T ci) {
+        using std::fabs;
+        T ar = fabs(zr), ai = fabs(zi);
+        zi = 2 * ar * ai + ci;
+        zr = ar * ar - ai * ai + cr;
+    }
+};
+
+// Scalar-type traits: lanes per batch and conversions
+template <class T> struct EscapeReal {
+    static const int LANES = 4;
+    static T make(const DD &origin, double offset) { return origin.hi + (origin.lo + offset); }
+    static double magnitude2(T r, T i) { return r * r + i * i; }
+};
+template <> struct EscapeReal<float> {
+    static const int LANES = 8;
+    static float make(const DD &origin, double offset) { return static_cast<float>(origin.hi + (origin.lo + offset)); }
+    static double magnitude2(float r, float i) { return r * r + i * i; }
+};
+template <> struct EscapeReal<DD> {
+    static const int LANES = 2;
+    static DD make(const DD &origin, double offset) { return origin + DD(offset); }
+    static double magnitude2(const DD &r, const DD &i) { return (r * r + i * i).hi; }
+};
+
+// Scalar escape-time kernel. Returns the iteration at which |z| first exceeds
+// 2, or maxIter. Julia variants start at z = point and iterate with fixed c.
+template <class Formula, bool Julia, class T>
+int escapeTime(T x, T y, T jr, T ji, int maxIter) {
+    T zr = Julia ? x : T(0.0), zi = Julia ? y : T(0.0);
+    const T cr = Julia ? jr : x, ci = Julia ? ji : y;
+    for (int i = 0; i < maxIter; ++i) {
+        Formula::step(zr, zi, cr, ci);
+        if (EscapeReal<T>::magnitude2(zr, zi) > 4.0) return i;
     }
     return maxIter;
 }
 
+// Lane-batched kernel: LANES points iterate together with an active mask and
+// branch-free counter updates, so the lane loops map onto SIMD registers; the
+// batch exits as soon as every lane has escaped.
+template <class Formula, bool Julia, class T>
+void escapeTimeBatch(const T *x, T y, T jr, T ji, int maxIter, int *out) {
+    const int L = EscapeReal<T>::LANES;
+    T zr[L], zi[L], cr[L], ci[L];
+    int count[L], active[L];
+    for (int l = 0; l < L; ++l) {
+        zr[l] = Julia ? x[l] : T(0.0); zi[l] = Julia ? y : T(0.0);
+        cr[l] = Julia ? jr : x[l]; ci[l] = Julia ? ji : y;
+        count[l] = 0; active[l] = 1;
+    }
+    for (int i = 0; i < maxIter; ++i) {
+        int any = 0;
+        for (int l = 0; l < L; ++l) {
+            Formula::step(zr[l], zi[l], cr[l], ci[l]);
+            active[l] &= (EscapeReal<T>::magnitude2(zr[l], zi[l]) <= 4.0) ? 1 : 0;
+            count[l] += active[l];
+            any |= active[l];
+        }
+        if (!any) break;
+    }
+    for (int l = 0; l < L; ++l) out[l] = count[l];
+}
+
+// Iteration counts for one row of points. Coordinates are offsets from the
+// params origin and are combined with it in the kernel's precision.
+template <class Formula, bool Julia, class T>
+void escapeTimeRowT(const double *xOff, int n, double yOff, const FractalParams &params, int maxIter, int *out) {
+    const int L = EscapeReal<T>::LANES;
+    const T y = EscapeReal<T>::make(params.originI, yOff);
+    const T jr = EscapeReal<T>::make(DD(params.juliaRe), 0.0), ji = EscapeReal<T>::make(DD(params.juliaIm), 0.0);
+    T xs[L];
+    int i = 0;
+    for (; i + L <= n; i += L) {
+        for (int l = 0; l < L; ++l) xs[l] = EscapeReal<T>::make(params.originR, xOff[i + l]);
+        escapeTimeBatch<Formula, Julia, T>(xs, y, jr, ji, maxIter, out + i);
+    }
+    for (; i < n; ++i) {
+        out[i] = escapeTime<Formula, Julia, T>(EscapeReal<T>::make(params.originR, xOff[i]), y, jr, ji, maxIter);
+    }
+}
+
+template <class Formula, bool Julia>
+void escapeTimeRowTier(int tier, const double *xOff, int n, double yOff, const FractalParams &params, int maxIter, int *out) {
+    if (tier == TIER_FLOAT) escapeTimeRowT<Formula, Julia, float>(xOff, n, yOff, params, maxIter, out);
+    else if (tier == TIER_DOUBLE) escapeTimeRowT<Formula, Julia, double>(xOff, n, yOff, params, maxIter, out);
+    else escapeTimeRowT<Formula, Julia, DD>(xOff, n, yOff, params, maxIter, out);
+}
+
+// Tier for a view rendered `width` x `height` pixels (finest axis decides)
+inline PrecisionTier escapePrecisionTier(double realMin, double realMax, double imagMin, double imagMax,
+                                         int width, int height) {
+    return selectPrecisionTier(std::min((realMax - realMin) / std::max(1, width - 1),
+                                        (imagMax - imagMin) / std::max(1, height - 1)));
+}
+
+// Select the specialized row kernel once per row
+void escapeTimeRow(int fractal, int tier, const double *xOff, int n, double yOff, const FractalParams &params,
+                   int maxIter, int *out) {
+    switch (fractal) {
+        case JULIA: escapeTimeRowTier<MandelbrotFormula, true>(tier, xOff, n, yOff, params, maxIter, out); break;
+        case MULTIBROT3: escapeTimeRowTier<MultibrotFormula<3>, false>(tier, xOff, n, yOff, params, maxIter, out); break;
+        case BURNING_SHIP: escapeTimeRowTier<BurningShipFormula, false>(tier, xOff, n, yOff, params, maxIter, out); break;
+        default: escapeTimeRowTier<MandelbrotFormula, false>(tier, xOff, n, yOff, params, maxIter, out); break;
+    }
+}
+
+// Per-pixel detail for raw exports: the iteration count of the kernels above
+// plus a continuous (smooth) iteration value, the final |z| and, for
+// conformal formulas, a distance estimate to the set boundary. The count
+// matches escapeTime exactly; after escape the orbit is followed in double
+// for at most 8 more steps, out to radius 256, so the smooth value has no
+// visible bands. It is normalized to the escape radius 2, so except where
+// |c| itself is large it stays close to [iterations, iterations + 1).
+struct EscapeDetail {
+    int iterations;
+    float smooth;
+    float absZ;
+    float distance; // NaN where the formula has no usable derivative
+};
+
+inline double escapeToDouble(float v) { return v; }
+inline double escapeToDouble(double v) { return v; }
+inline double escapeToDouble(const DD &v) { return v.toDouble(); }
+
+// dz <- f'(z) dz for the formulas; Burning Ship folds z and is not conformal
+template <class Formula> struct EscapeDerivative;
+template <> struct EscapeDerivative<MandelbrotFormula> {
+    static const int POWER = 2;
+    static const bool CONFORMAL = true;
+    static void apply(double zr, double zi, double &dr, double &di) {
+        double nr = 2.0 * (zr * dr - zi * di);
+        di = 2.0 * (zr * di + zi * dr);
+        dr = nr;
+    }
+};
+template <int Power> struct EscapeDerivative<MultibrotFormula<Power> > {
+    static const int POWER = Power;
+    static const bool CONFORMAL = true;
+    static void apply(double zr, double zi, double &dr, double &di) {
+        double pr = Power, pi = 0.0; // Power * z^(Power-1)
+        for (int k = 1; k < Power; ++k) {
+            double nr = pr * zr - pi * zi;
+            pi = pr * zi + pi * zr;
+            pr = nr;
+        }
+        double nr = pr * dr - pi * di;
+        di = pr * di + pi * dr;
+        dr = nr;
+    }
+};
+template <> struct EscapeDerivative<BurningShipFormula> {
+    static const int POWER = 2;
+    static const bool CONFORMAL = false;
+    static void apply(double, double, double &, double &) {}
+};
+
+template <class Formula, bool Julia, class T>
+EscapeDetail escapeDetail(T x, T y, T jr, T ji, int maxIter) {
+    typedef EscapeDerivative<Formula> D;
+    T zr = Julia ? x : T(0.0), zi = Julia ? y : T(0.0);
+    const T cr = Julia ? jr : x, ci = Julia ? ji : y;
+    double dr = Julia ? 1.0 : 0.0, di = 0.0;
+    EscapeDetail d;
+    for (int i = 0; i < maxIter; ++i) {
+        D::apply(escapeToDouble(zr), escapeToDouble(zi), dr, di);
+        if (!Julia) dr += 1.0;
+        Formula::step(zr, zi, cr, ci);
+        if (EscapeReal<T>::magnitude2(zr, zi) > 4.0) {
+            double r = escapeToDouble(zr), s = escapeToDouble(zi);
+            const double cR = escapeToDouble(cr), cI = escapeToDouble(ci);
+            int m = i;
+            for (int k = 0; k < 8 && r * r + s * s < 65536.0; ++k, ++m) {
+                D::apply(r, s, dr, di);
+                if (!Julia) dr += 1.0;
+                Formula::step(r, s, cR, cI);
+            }
+            const double absZ = std::sqrt(r * r + s * s);
+            const double absD = std::sqrt(dr * dr + di * di);
+            d.iterations = i;
+            d.smooth = static_cast<float>(m + 1 - std::log(std::log(absZ) / std::log(2.0)) / std::log(static_cast<double>(D::POWER)));
+            d.absZ = static_cast<float>(absZ);
+            d.distance = D::CONFORMAL && absD > 0.0 ? static_cast<float>(absZ * std::log(absZ) / absD)
+                                                    : std::numeric_limits<float>::quiet_NaN();
+            return d;
+        }
+    }
+    d.iterations = maxIter;
+    d.smooth = static_cast<float>(maxIter);
+    d.absZ = static_cast<float>(std::sqrt(EscapeReal<T>::magnitude2(zr, zi)));
+    d.distance = D::CONFORMAL ? 0.0f : std::numeric_limits<float>::quiet_NaN();
+    return d;
+}
+
+template <class Formula, bool Julia, class T>
+void escapeDetailRowT(const double *xOff, int n, double yOff, const FractalParams &params, int maxIter, EscapeDetail *out) {
+    const T y = EscapeReal<T>::make(params.originI, yOff);
+    const T jr = EscapeReal<T>::make(DD(params.juliaRe), 0.0), ji = EscapeReal<T>::make(DD(params.juliaIm), 0.0);
+    for (int i = 0; i < n; ++i) {
+        out[i] = escapeDetail<Formula, Julia, T>(EscapeReal<T>::make(params.originR, xOff[i]), y, jr, ji, maxIter);
+    }
+}
+
+template <class Formula, bool Julia>
+void escapeDetailRowTier(int tier, const double *xOff, int n, double yOff, const FractalParams &params, int maxIter,
+                         EscapeDetail *out) {
+    if (tier == TIER_FLOAT) escapeDetailRowT<Formula, Julia, float>(xOff, n, yOff, params, maxIter, out);
+    else if (tier == TIER_DOUBLE) escapeDetailRowT<Formula, Julia, double>(xOff, n, yOff, params, maxIter, out);
+    else escapeDetailRowT<Formula, Julia, DD>(xOff, n, yOff, params, maxIter, out);
+}
+
+// Detail counterpart of escapeTimeRow (scalar; exports are offline)
+void escapeDetailRow(int fractal, int tier, const double *xOff, int n, double yOff, const FractalParams &params,
+                     int maxIter, EscapeDetail *out) {
+    switch (fractal) {
+        case JULIA: escapeDetailRowTier<MandelbrotFormula, true>(tier, xOff, n, yOff, params, maxIter, out); break;
+        case MULTIBROT3: escapeDetailRowTier<MultibrotFormula<3>, false>(tier, xOff, n, yOff, params, maxIter, out); break;
+        case BURNING_SHIP: escapeDetailRowTier<BurningShipFormula, false>(tier, xOff, n, yOff, params, maxIter, out); break;
+        default: escapeDetailRowTier<MandelbrotFormula, false>(tier, xOff, n, yOff, params, maxIter, out); break;
+    }
+}
+
+// Function to calculate Mandelbrot set value for a point
+int calculateMandelbrot(double x, double y, int maxIter) {
+    return escapeTime<MandelbrotFormula, false, double>(x, y, 0.0, 0.0, maxIter);
+}
+
 // Function to map a value from one range to another
 double map(double value, double inMin, double inMax, double outMin, double outMax) {
     return outMin + (value - inMin) * (outMax - outMin) / (inMax - inMin);
@@ -81,6 +745,14 @@ inline int imagToPixel(double i, int height, double imagMin, double imagMax) {
     return static_cast<int>(map(i, imagMax, imagMin, 0.0, static_cast<double>(height - 1)));
 }
 
+// View bounds in the complex plane
+struct ViewBounds {
+    double realMin = 0.0, realMax = 0.0, imagMin = 0.0, imagMax = 0.0;
+    ViewBounds() {}
+    ViewBounds(double rmin, double rmax, double imin, double imax)
+        : realMin(rmin), realMax(rmax), imagMin(imin), imagMax(imax) {}
+};
+
 // Draw a straight line between two pixel coordinates on an image
 void drawLine(sf::Image &image, int x0, int y0, int x1, int y1, const sf::Color &col) {
     const int dx = std::abs(x1 - x0);
@@ -99,77 +771,626 @@ void drawLine(sf::Image &image, int x0, int y0, int x1, int y1, const sf::Color
     }
 }
 
-// Mandelbrot renderer (was previous renderFractal)
-void renderMandelbrot(sf::Image &image, int width, int height,
-                      double realMin, double realMax,
-                      double imagMin, double imagMax,
-                      int maxIter) {
-    int minX = width, minY = height, maxX = 0, maxY = 0;
-    for (int x = 0; x < width; ++x) {
-        for (int y = 0; y < height; ++y) {
-            double realPart = pixelToReal(x, width, realMin, realMax);
-            double imagPart = pixelToImag(y, height, imagMin, imagMax);
+// Escape-time coloring: interior black, exterior shaded by iteration count
+// in a per-fractal hue (Mandelbrot keeps its blue)
+inline sf::Color escapeColor(int fractal, int iterations, int maxIter) {
+    if (iterations == maxIter) return sf::Color::Black;
+    const sf::Uint8 v = static_cast<sf::Uint8>(map(iterations, 0, maxIter, 0, 255));
+    switch (fractal) {
+        case JULIA: return sf::Color(v, 0, v);                                       // magenta
+        case MULTIBROT3: return sf::Color(0, v, static_cast<sf::Uint8>(v / 2));      // teal
+        case BURNING_SHIP: return sf::Color(v, static_cast<sf::Uint8>(v / 2), 0);    // orange
+        default: return sf::Color(0, 0, v);                                         // blue
+    }
+}
+
+// Whole-file read/write memory mapping. open() creates or resizes the file to
+// `bytes` when writable; bytes == 0 maps the existing file at its current size.
+struct MappedFile {
+    uint8_t *data = nullptr;
+    size_t size = 0;
+    bool existed = false; // file was already present with at least `bytes`
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+
+    MappedFile() {}
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const std::string &path, size_t bytes, bool writable) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ, FILE_SHARE_READ,
+                           nullptr, writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER current;
+        if (!GetFileSizeEx(file, &current)) { close(); return false; }
+        existed = bytes == 0 || static_cast<uint64_t>(current.QuadPart) >= bytes;
+        if (bytes == 0) bytes = static_cast<size_t>(current.QuadPart);
+        if (bytes == 0) { close(); return false; }
+        LARGE_INTEGER want;
+        want.QuadPart = static_cast<LONGLONG>(bytes);
+        // mapping a writable file larger than it is extends it
+        mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                     static_cast<DWORD>(want.HighPart), want.LowPart, nullptr);
+        if (!mapping) { close(); return false; }
+        data = static_cast<uint8_t *>(MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, bytes));
+        if (!data) { close(); return false; }
+#else
+        fd = ::open(path.c_str(), writable ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) { close(); return false; }
+        existed = bytes == 0 || static_cast<uint64_t>(st.st_size) >= bytes;
+        if (bytes == 0) bytes = static_cast<size_t>(st.st_size);
+        if (bytes == 0) { close(); return false; }
+        if (writable && static_cast<uint64_t>(st.st_size) < bytes && ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            close(); return false;
+        }
+        void *p = mmap(nullptr, bytes, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) { close(); return false; }
+        data = static_cast<uint8_t *>(p);
+#endif
+        size = bytes;
+        return true;
+    }
+
+    bool isOpen() const { return data != nullptr; }
+
+    void close() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr; file = INVALID_HANDLE_VALUE;
+#else
+        if (data) munmap(data, size);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        data = nullptr; size = 0;
+    }
+};
+
+// Persistent tile cache for escape-time iteration counts (parameter-free
+// formulas only). Samples lie on a
+// quadtree lattice anchored at the default view: level 0 has the default
+// view's pixel spacing, each level halves it, and a tile is TILE x TILE
+// samples addressed by (fractal, maxIter, level, tier, tx, ty). The precision
+// tier is part of the key, so a tile computed under other tier thresholds is
+// never served. A view whose pixels
+// fall exactly on a lattice level (the default view, whole-pixel pans and
+// factor-of-2 zooms of it) is assembled from tiles and only the missing tiles
+// are computed. Tiles live in a memory-mapped file with a fixed number of
+// slots; when it is full the least recently used slot is reused.
+struct TileCache {
+    static const int TILE = 64;
+    static const int MIN_LEVEL = -4;
+    static const int MAX_LEVEL = 20; // keeps lattice indices within int32
+    static const uint32_t MAGIC = 0x32435446; // "FTC2": slots carry the precision tier
+    static const size_t HEADER_BYTES = 64;
+
+    struct Header {
+        uint32_t magic, tileSize, slotCount, reserved;
+        double originR, originI, spacingR, spacingI;
+    };
+    struct Slot {
+        int32_t fractal, maxIter, level, tier, tx, ty;
+        uint32_t valid;
+        uint64_t lastUse;
+    };
+    struct Key {
+        int32_t fractal, maxIter, level, tier, tx, ty;
+        bool operator==(const Key &o) const {
+            return fractal == o.fractal && maxIter == o.maxIter && level == o.level && tier == o.tier &&
+                   tx == o.tx && ty == o.ty;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key &k) const {
+            uint64_t h = 1469598103934665603ULL;
+            const int32_t v[6] = {k.fractal, k.maxIter, k.level, k.tier, k.tx, k.ty};
+            for (int i = 0; i < 6; ++i) { h ^= static_cast<uint32_t>(v[i]); h *= 1099511628211ULL; }
+            return static_cast<size_t>(h);
+        }
+    };
 
-            int iterations = calculateMandelbrot(realPart, imagPart, maxIter);
+    MappedFile file;
+    Header *header = nullptr;
+    Slot *slots = nullptr;
+    uint16_t *tiles = nullptr;
+    uint32_t slotCount = 0;
+    std::unordered_map<Key, uint32_t, KeyHash> index;
+    std::vector<uint32_t> freeSlots;
+    uint64_t useCounter = 0;
+    std::mutex m;
+    // cumulative counters; telemetry reports per-frame deltas
+    uint64_t hits = 0, misses = 0, bytesRead = 0;
 
-            sf::Color color;
-            if (iterations == maxIter) {
-                color = sf::Color::Black;
+    static size_t tileBytes() { return sizeof(uint16_t) * TILE * TILE; }
+
+    bool open(const std::string &path, size_t capBytes, double originR, double originI, double spacingR, double spacingI) {
+        slotCount = static_cast<uint32_t>(std::max<size_t>(16, capBytes / (tileBytes() + sizeof(Slot))));
+        const size_t total = HEADER_BYTES + slotCount * (sizeof(Slot) + tileBytes());
+        if (!file.open(path, total, true)) { std::cerr << "TileCache: cannot map " << path << "\n"; return false; }
+        header = reinterpret_cast<Header *>(file.data);
+        slots = reinterpret_cast<Slot *>(file.data + HEADER_BYTES);
+        tiles = reinterpret_cast<uint16_t *>(file.data + HEADER_BYTES + slotCount * sizeof(Slot));
+        const bool valid = file.existed && header->magic == MAGIC && header->tileSize == TILE &&
+                           header->slotCount == slotCount && header->originR == originR &&
+                           header->originI == originI && header->spacingR == spacingR && header->spacingI == spacingI;
+        if (!valid) {
+            // new file, different size cap or different lattice: start empty
+            std::memset(file.data, 0, HEADER_BYTES + slotCount * sizeof(Slot));
+            header->magic = MAGIC; header->tileSize = TILE; header->slotCount = slotCount;
+            header->originR = originR; header->originI = originI;
+            header->spacingR = spacingR; header->spacingI = spacingI;
+        }
+        for (uint32_t i = slotCount; i-- > 0;) {
+            const Slot &s = slots[i];
+            if (s.valid) {
+                index[Key{s.fractal, s.maxIter, s.level, s.tier, s.tx, s.ty}] = i;
+                useCounter = std::max(useCounter, s.lastUse);
             } else {
-                uint8_t blue = static_cast<sf::Uint8>(map(iterations, 0, maxIter, 0, 255));
-                color = sf::Color(0, 0, blue);
+                freeSlots.push_back(i);
             }
+        }
+        std::cout << "TileCache: " << index.size() << "/" << slotCount << " tiles in " << path << "\n";
+        return true;
+    }
 
-            image.setPixel(x, y, color);
-            if (color != sf::Color::Black) {
-                minX = std::min(minX, x); maxX = std::max(maxX, x);
-                minY = std::min(minY, y); maxY = std::max(maxY, y);
+    bool isOpen() const { return file.isOpen(); }
+
+    // Lattice level whose spacing matches `spacing`, if any
+    static bool matchLevel(double spacing, double rootSpacing, int &level) {
+        if (spacing <= 0.0) return false;
+        double l = std::log2(rootSpacing / spacing);
+        level = static_cast<int>(std::lround(l));
+        return std::fabs(l - level) < 1e-6 && level >= MIN_LEVEL && level <= MAX_LEVEL;
+    }
+
+    // Lattice index of coordinate offset `off` at `spacing`, if it lies on the lattice
+    static bool matchIndex(double off, double spacing, int64_t &idx) {
+        double f = off / spacing;
+        idx = static_cast<int64_t>(std::llround(f));
+        return std::fabs(f - static_cast<double>(idx)) < 1e-3;
+    }
+
+    // Evict the least recently used slot (linear scan; tiles are expensive
+    // compared to a few thousand slot headers)
+    uint32_t takeSlot() {
+        if (!freeSlots.empty()) { uint32_t s = freeSlots.back(); freeSlots.pop_back(); return s; }
+        uint32_t victim = 0;
+        for (uint32_t i = 1; i < slotCount; ++i) if (slots[i].lastUse < slots[victim].lastUse) victim = i;
+        const Slot &old = slots[victim];
+        index.erase(Key{old.fractal, old.maxIter, old.level, old.tier, old.tx, old.ty});
+        return victim;
+    }
+
+    // Iteration counts of one tile, computed on a miss. Caller holds `m`.
+    const uint16_t *fetch(const Key &key, double spacingR, double spacingI) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            slots[it->second].lastUse = ++useCounter;
+            hits++;
+            bytesRead += tileBytes();
+            return tiles + static_cast<size_t>(it->second) * TILE * TILE;
+        }
+        misses++;
+        const uint32_t s = takeSlot();
+        uint16_t *dst = tiles + static_cast<size_t>(s) * TILE * TILE;
+        double xs[TILE];
+        int iters[TILE];
+        for (int i = 0; i < TILE; ++i) {
+            xs[i] = header->originR + static_cast<double>(static_cast<int64_t>(key.tx) * TILE + i) * spacingR;
+        }
+        for (int j = 0; j < TILE; ++j) {
+            const double im = header->originI - static_cast<double>(static_cast<int64_t>(key.ty) * TILE + j) * spacingI;
+            escapeTimeRow(key.fractal, key.tier, xs, TILE, im, FractalParams(), key.maxIter, iters);
+            for (int i = 0; i < TILE; ++i) dst[j * TILE + i] = static_cast<uint16_t>(iters[i]);
+        }
+        Slot &slot = slots[s];
+        slot.fractal = key.fractal; slot.maxIter = key.maxIter; slot.level = key.level; slot.tier = key.tier;
+        slot.tx = key.tx; slot.ty = key.ty; slot.lastUse = ++useCounter; slot.valid = 1;
+        index[key] = s;
+        return dst;
+    }
+
+    // Assemble a lattice-aligned view from tiles; false if the view is not aligned
+    bool render(sf::Image &image, int width, int height, const ViewBounds &v, int fractal, int maxIter,
+                int *iters = nullptr) {
+        if (!isOpen() || maxIter > 65535 || width < 2 || height < 2) return false;
+        int levelR = 0, levelI = 0;
+        if (!matchLevel((v.realMax - v.realMin) / (width - 1), header->spacingR, levelR)) return false;
+        if (!matchLevel((v.imagMax - v.imagMin) / (height - 1), header->spacingI, levelI) || levelI != levelR) return false;
+        const double sR = std::ldexp(header->spacingR, -levelR);
+        const double sI = std::ldexp(header->spacingI, -levelR);
+        const int tier = selectPrecisionTier(std::min(sR, sI));
+        int64_t i0 = 0, j0 = 0;
+        if (!matchIndex(v.realMin - header->originR, sR, i0) || !matchIndex(header->originI - v.imagMax, sI, j0)) return false;
+
+        auto floorDiv = [](int64_t a, int64_t b) { return a >= 0 ? a / b : -((-a + b - 1) / b); };
+        std::lock_guard<std::mutex> lk(m);
+        for (int64_t ty = floorDiv(j0, TILE); ty <= floorDiv(j0 + height - 1, TILE); ++ty) {
+            for (int64_t tx = floorDiv(i0, TILE); tx <= floorDiv(i0 + width - 1, TILE); ++tx) {
+                const Key key{fractal, maxIter, levelR, tier, static_cast<int32_t>(tx), static_cast<int32_t>(ty)};
+                const uint16_t *tile = fetch(key, sR, sI);
+                const int64_t ys = std::max(j0, ty * TILE), ye = std::min(j0 + height, (ty + 1) * TILE);
+                const int64_t xs = std::max(i0, tx * TILE), xe = std::min(i0 + width, (tx + 1) * TILE);
+                for (int64_t j = ys; j < ye; ++j) {
+                    const uint16_t *row = tile + (j - ty * TILE) * TILE;
+                    for (int64_t i = xs; i < xe; ++i) {
+                        image.setPixel(static_cast<unsigned>(i - i0), static_cast<unsigned>(j - j0),
+                                       escapeColor(fractal, row[i - tx * TILE], maxIter));
+                        if (iters) iters[(j - j0) * width + (i - i0)] = row[i - tx * TILE];
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+
+// Refined pixels of recently antialiased frames. Escape-time views are
+// rendered again on every idle frame (from the tile cache when it covers
+// them); a frame whose view, parameters and base-pass counts match an entry
+// gets that entry's colors back instead of recomputing its sub-samples.
+// Shared by all threads, with one entry per band of a banded render.
+class AntialiasMemo {
+public:
+    struct Entry {
+        int fractal = 0, maxIter = 0, tier = 0, width = 0, height = 0;
+        ViewBounds view;
+        FractalParams params;
+        uint64_t gridHash = 0, lastUse = 0;
+        std::vector<uint32_t> at;     // refined pixel offsets
+        std::vector<sf::Color> color; // and their averaged colors
+    };
+
+    static AntialiasMemo &shared() {
+        static AntialiasMemo memo;
+        return memo;
+    }
+
+    // Apply the entry matching `key` to `image`; false when there is none
+    bool apply(const Entry &key, sf::Image &image, uint64_t &refined) {
+        std::lock_guard<std::mutex> lk(m);
+        for (Entry &e : entries) {
+            if (!e.lastUse || !sameFrame(e, key)) continue;
+            e.lastUse = ++clock;
+            for (size_t i = 0; i < e.at.size(); ++i) image.setPixel(e.at[i] % key.width, e.at[i] / key.width, e.color[i]);
+            refined = e.at.size();
+            return true;
+        }
+        return false;
+    }
+
+    // Keep `key` with the pixels in at/color in place of the least recently
+    // used entry; at and color get that entry's buffers back, so storing
+    // does not allocate once the entries have grown
+    void store(const Entry &key, std::vector<uint32_t> &at, std::vector<sf::Color> &color) {
+        std::lock_guard<std::mutex> lk(m);
+        Entry *victim = &entries[0];
+        for (Entry &e : entries) {
+            if (e.lastUse < victim->lastUse) victim = &e;
+        }
+        victim->fractal = key.fractal; victim->maxIter = key.maxIter; victim->tier = key.tier;
+        victim->width = key.width; victim->height = key.height;
+        victim->view = key.view; victim->params = key.params; victim->gridHash = key.gridHash;
+        victim->lastUse = ++clock;
+        victim->at.swap(at);
+        victim->color.swap(color);
+    }
+
+private:
+    static bool sameFrame(const Entry &a, const Entry &b) {
+        return a.fractal == b.fractal && a.maxIter == b.maxIter && a.tier == b.tier && a.width == b.width &&
+               a.height == b.height && a.gridHash == b.gridHash && a.view.realMin == b.view.realMin &&
+               a.view.realMax == b.view.realMax && a.view.imagMin == b.view.imagMin && a.view.imagMax == b.view.imagMax &&
+               a.params.originR.hi == b.params.originR.hi && a.params.originR.lo == b.params.originR.lo &&
+               a.params.originI.hi == b.params.originI.hi && a.params.originI.lo == b.params.originI.lo &&
+               a.params.juliaRe == b.params.juliaRe && a.params.juliaIm == b.params.juliaIm;
+    }
+
+    std::mutex m;
+    Entry entries[16];
+    uint64_t clock = 0;
+};
+
+// Adaptive antialiasing after the base pass. Each pixel's shade is compared
+// with its 3x3 neighbourhood; where the standard deviation is high (edges,
+// filaments, interior/exterior boundaries) the pixel is re-rendered from an
+// n x n stratified grid of sub-pixel samples, n = 2, 3 or 4 growing with the
+// deviation, and the sample colors are averaged. The middle sample of the 3x3
+// grid is the pixel center, taken from the base pass. Flat regions, including
+// the interior, get no extra samples. Sub-samples of one row are batched per
+// grid row so they go through the row kernel like a normal row. A frame seen
+// before is served from AntialiasMemo.
+void antialiasEscapeTime(sf::Image &image, const std::vector<int> &iters, int width, int height,
+                         double realMin, double realMax, double imagMin, double imagMax,
+                         int maxIter, int fractal, int tier, const FractalParams &params, RenderStats *stats) {
+    const size_t count = static_cast<size_t>(width) * height;
+    AntialiasMemo::Entry key;
+    key.fractal = fractal; key.maxIter = maxIter; key.tier = tier; key.width = width; key.height = height;
+    key.view = ViewBounds(realMin, realMax, imagMin, imagMax);
+    key.params = params;
+    uint64_t h = 1469598103934665603ull; // FNV-1a over the base-pass counts
+    for (size_t i = 0; i < count; ++i) h = (h ^ static_cast<uint32_t>(iters[i])) * 1099511628211ull;
+    key.gridHash = h;
+    uint64_t refined = 0, samples = 0;
+    if (AntialiasMemo::shared().apply(key, image, refined)) {
+        if (stats) stats->aaPixels += refined;
+        return;
+    }
+
+    // 3x3 sums of the shade (0..255, as escapeColor maps it) and its square,
+    // separably and in integers; 81 * variance = 9 * sum2 - sum^2
+    // scratch buffers persist per thread, so steady-state frames do not allocate
+    static thread_local std::vector<int> shadeOf, sh, hs, hs2;
+    shadeOf.resize(maxIter + 1);
+    for (int it = 0; it <= maxIter; ++it) shadeOf[it] = it >= maxIter ? 0 : (it * 255) / maxIter;
+    sh.resize(count); hs.resize(count); hs2.resize(count);
+    for (size_t i = 0; i < count; ++i) sh[i] = shadeOf[std::min(iters[i], maxIter)];
+    for (int y = 0; y < height; ++y) {
+        const int *r = sh.data() + static_cast<size_t>(y) * width;
+        int *o = hs.data() + static_cast<size_t>(y) * width, *o2 = hs2.data() + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; ++x) {
+            const int a = r[x > 0 ? x - 1 : 0], b = r[x], c = r[x + 1 < width ? x + 1 : x];
+            o[x] = a + b + c;
+            o2[x] = a * a + b * b + c * c;
+        }
+    }
+    static thread_local std::vector<uint8_t> level, rowLevel;
+    level.resize(count);
+    rowLevel.resize(height); // highest level in each row, so flat rows are skipped
+    const int T2 = 6 * 6 * 81, T3 = 16 * 16 * 81, T4 = 40 * 40 * 81; // sigma thresholds 6, 16, 40
+    for (int y = 0; y < height; ++y) {
+        const size_t up = static_cast<size_t>(y > 0 ? y - 1 : 0) * width, mid = static_cast<size_t>(y) * width;
+        const size_t dn = static_cast<size_t>(y + 1 < height ? y + 1 : y) * width;
+        uint8_t top = 0;
+        for (int x = 0; x < width; ++x) {
+            const int sum = hs[up + x] + hs[mid + x] + hs[dn + x];
+            const int var81 = 9 * (hs2[up + x] + hs2[mid + x] + hs2[dn + x]) - sum * sum;
+            const uint8_t l = var81 >= T4 ? 4 : (var81 >= T3 ? 3 : (var81 >= T2 ? 2 : 0));
+            level[mid + x] = l;
+            top = std::max(top, l);
+        }
+        rowLevel[y] = top;
+    }
+    const double dx = (realMax - realMin) / (width - 1);
+    const double dy = (imagMax - imagMin) / (height - 1);
+    static thread_local std::vector<int> pix, out, rgb;
+    static thread_local std::vector<double> xs, xsMid;
+    static thread_local std::vector<uint32_t> memoAt;
+    static thread_local std::vector<sf::Color> memoColor;
+    // sized for the worst row (every pixel at n = 4) so they never grow mid-frame
+    pix.reserve(width); xs.reserve(4 * static_cast<size_t>(width)); xsMid.reserve(2 * static_cast<size_t>(width));
+    out.reserve(4 * static_cast<size_t>(width)); rgb.reserve(3 * static_cast<size_t>(width));
+    memoAt.clear(); memoColor.clear();
+    for (int y = 0; y < height; ++y) {
+        if (!rowLevel[y]) continue;
+        const double yc = pixelToImag(y, height, imagMin, imagMax);
+        for (int n = 2; n <= 4; ++n) {
+            pix.clear();
+            for (int x = 0; x < width; ++x) {
+                if (level[static_cast<size_t>(y) * width + x] == n) pix.push_back(x);
+            }
+            if (pix.empty()) continue;
+            const int m = static_cast<int>(pix.size());
+            const int c = (n & 1) ? n / 2 : -1; // grid column/row through the pixel center
+            xs.resize(static_cast<size_t>(m) * n);
+            out.resize(xs.size());
+            rgb.assign(static_cast<size_t>(m) * 3, 0);
+            xsMid.clear();
+            for (int k = 0; k < m; ++k) {
+                const double xc = pixelToReal(pix[k], width, realMin, realMax);
+                for (int i = 0; i < n; ++i) {
+                    xs[k * n + i] = xc + ((i + 0.5) / n - 0.5) * dx;
+                    if (i != c) xsMid.push_back(xs[k * n + i]);
+                }
+            }
+            for (int j = 0; j < n; ++j) {
+                // the center row leaves out the center sample (offset 0, so
+                // the same coordinates as the base pass)
+                const bool centerRow = j == c;
+                const std::vector<double> &row = centerRow ? xsMid : xs;
+                const int per = centerRow ? n - 1 : n;
+                escapeTimeRow(fractal, tier, row.data(), static_cast<int>(row.size()), yc - ((j + 0.5) / n - 0.5) * dy,
+                              params, maxIter, out.data());
+                samples += row.size();
+                for (int k = 0; k < m; ++k) {
+                    for (int i = 0; i < n; ++i) {
+                        const int it = !centerRow ? out[k * n + i]
+                                     : i == c ? iters[static_cast<size_t>(y) * width + pix[k]]
+                                              : out[k * per + i - (i > c)];
+                        const sf::Color col = escapeColor(fractal, it, maxIter);
+                        rgb[3 * k] += col.r; rgb[3 * k + 1] += col.g; rgb[3 * k + 2] += col.b;
+                    }
+                }
+            }
+            const int nn = n * n;
+            for (int k = 0; k < m; ++k) {
+                const sf::Color col(static_cast<sf::Uint8>((rgb[3 * k] + nn / 2) / nn),
+                                    static_cast<sf::Uint8>((rgb[3 * k + 1] + nn / 2) / nn),
+                                    static_cast<sf::Uint8>((rgb[3 * k + 2] + nn / 2) / nn));
+                image.setPixel(pix[k], y, col);
+                memoAt.push_back(static_cast<uint32_t>(static_cast<size_t>(y) * width + pix[k]));
+                memoColor.push_back(col);
+            }
+            refined += m;
+        }
+    }
+    AntialiasMemo::shared().store(key, memoAt, memoColor);
+    if (stats) { stats->aaPixels += refined; stats->aaSamples += samples; }
+}
+
+// Escape-time renderer for Mandelbrot, Julia, Multibrot and Burning Ship
+// (was renderMandelbrot). Bounds are relative to params' origin. Rows go
+// through the row kernel specialized for the frame's precision tier;
+// lattice-aligned views are assembled from the tile cache when one is given
+// (the registry withholds it from Julia, whose c is not part of the tile key).
+void renderEscapeTime(sf::Image &image, int width, int height,
+                      double realMin, double realMax,
+                      double imagMin, double imagMax,
+                      int maxIter, int fractal, const FractalParams &params,
+                      TileCache *tiles = nullptr, RenderStats *stats = nullptr,
+                      std::vector<int> *iterations = nullptr) {
+    const int tier = escapePrecisionTier(realMin, realMax, imagMin, imagMax, width, height);
+    // base-pass counts go straight into the caller's buffer when it wants
+    // them, else into a per-thread scratch grid; both keep their capacity
+    static thread_local std::vector<int> scratchGrid;
+    std::vector<int> &grid = iterations ? *iterations : scratchGrid;
+    grid.resize(static_cast<size_t>(width) * height);
+    if (stats) stats->basePixels += grid.size();
+    // the tile lattice is absolute; only shallow views hit it, where the
+    // origin folds into doubles exactly enough
+    const double oR = params.originR.toDouble(), oI = params.originI.toDouble();
+    // (views assembled from tiles are not logged: an idle frame re-renders
+    // every loop, and the overlay's Tiles line shows the hit rate)
+    if (!tiles ||
+        !tiles->render(image, width, height, ViewBounds(oR + realMin, oR + realMax, oI + imagMin, oI + imagMax), fractal, maxIter,
+                       grid.data())) {
+        int minX = width, minY = height, maxX = 0, maxY = 0;
+        static thread_local std::vector<double> xs;
+        xs.resize(width);
+        for (int x = 0; x < width; ++x) xs[x] = pixelToReal(x, width, realMin, realMax);
+        for (int y = 0; y < height; ++y) {
+            double imagPart = pixelToImag(y, height, imagMin, imagMax);
+            int *iters = grid.data() + static_cast<size_t>(y) * width;
+            escapeTimeRow(fractal, tier, xs.data(), width, imagPart, params, maxIter, iters);
+            for (int x = 0; x < width; ++x) {
+                sf::Color color = escapeColor(fractal, iters[x], maxIter);
+                image.setPixel(x, y, color);
+                if (iters[x] != maxIter) {
+                    minX = std::min(minX, x); maxX = std::max(maxX, x);
+                    minY = std::min(minY, y); maxY = std::max(maxY, y);
+                }
             }
         }
+        std::cout << "Escape-time fractal=" << fractal << " tier=" << precisionTierName(tier)
+                  << " drawn bounds px=["<<minX<<","<<maxX<<"] py=["<<minY<<","<<maxY<<"]\n";
     }
-    std::cout << "Mandelbrot drawn bounds px=["<<minX<<","<<maxX<<"] py=["<<minY<<","<<maxY<<"]\n";
+    if (params.antialias) {
+        antialiasEscapeTime(image, grid, width, height, realMin, realMax, imagMin, imagMax, maxIter, fractal, tier, params, stats);
+    }
+}
+
+// Sierpinski triangle by recursive subdivision. The triangle is fixed in world
+// coordinates (the corners of the initial view: top edge along imagMax, apex at
+// the bottom) and is mapped to pixel space once; each triangle splits into its
+// three corner sub-triangles until it is smaller than a pixel, where it is
+// rasterized as that pixel. Sub-triangles outside the viewport are culled, so
+// the cost follows the visible detail and the output is identical on every
+// frame. The first levels are expanded into a list of visible subtrees that the
+// worker threads share, each rasterizing into a private mask.
+struct SierpinskiTri { double ax, ay, bx, by, cx, cy; };
+
+inline bool sierpinskiVisible(const SierpinskiTri &t, int width, int height) {
+    const double minX = std::min({t.ax, t.bx, t.cx}), maxX = std::max({t.ax, t.bx, t.cx});
+    const double minY = std::min({t.ay, t.by, t.cy}), maxY = std::max({t.ay, t.by, t.cy});
+    return maxX >= -0.5 && minX <= width - 0.5 && maxY >= -0.5 && minY <= height - 0.5;
+}
+
+inline bool sierpinskiIsPixel(const SierpinskiTri &t) {
+    return std::max({t.ax, t.bx, t.cx}) - std::min({t.ax, t.bx, t.cx}) < 1.0 &&
+           std::max({t.ay, t.by, t.cy}) - std::min({t.ay, t.by, t.cy}) < 1.0;
+}
+
+inline void sierpinskiSplit(const SierpinskiTri &t, SierpinskiTri out[3]) {
+    const double abx = (t.ax + t.bx) / 2.0, aby = (t.ay + t.by) / 2.0;
+    const double bcx = (t.bx + t.cx) / 2.0, bcy = (t.by + t.cy) / 2.0;
+    const double cax = (t.cx + t.ax) / 2.0, cay = (t.cy + t.ay) / 2.0;
+    out[0] = {t.ax, t.ay, abx, aby, cax, cay};
+    out[1] = {abx, aby, t.bx, t.by, bcx, bcy};
+    out[2] = {cax, cay, bcx, bcy, t.cx, t.cy};
+}
+
+void sierpinskiRaster(const SierpinskiTri &t, int width, int height, int depth, uint8_t *mask, uint64_t &visited) {
+    if (!sierpinskiVisible(t, width, height)) return;
+    ++visited;
+    // depth cap: below ~2^-52 of the triangle doubles can no longer split it
+    if (sierpinskiIsPixel(t) || depth >= 60) {
+        const int px = static_cast<int>(std::floor((t.ax + t.bx + t.cx) / 3.0 + 0.5));
+        const int py = static_cast<int>(std::floor((t.ay + t.by + t.cy) / 3.0 + 0.5));
+        if (px >= 0 && px < width && py >= 0 && py < height) mask[static_cast<size_t>(py) * width + px] = 1;
+        return;
+    }
+    SierpinskiTri sub[3];
+    sierpinskiSplit(t, sub);
+    for (int i = 0; i < 3; ++i) sierpinskiRaster(sub[i], width, height, depth + 1, mask, visited);
 }
 
-// Sierpiński triangle using chaos game — compute in pixel space so zoom/center
-// consistently affect the algorithm. This avoids subtle numeric mismatches
-// between world<->pixel conversions when zooming and panning.
 void renderSierpinski(sf::Image &image, int width, int height,
                       double realMin, double realMax,
                       double imagMin, double imagMax) {
     std::cout << "Sierpinski render bounds: ["<<realMin<<","<<realMax<<","<<imagMin<<","<<imagMax<<"]\n";
     // clear background
-    image.create(width, height, sf::Color::Black);
-    // compute triangle vertices in pixel coordinates by mapping world coords
-    int v1x = realToPixel(realMin, width, realMin, realMax);
-    int v1y = imagToPixel(imagMax, height, imagMin, imagMax);
-    int v2x = realToPixel(realMax, width, realMin, realMax);
-    int v2y = imagToPixel(imagMax, height, imagMin, imagMax);
-    int v3x = realToPixel((realMin + realMax) / 2.0, width, realMin, realMax);
-    int v3y = imagToPixel(imagMin, height, imagMin, imagMax);
-
-    // start at centroid in pixel space
-    double prx = (static_cast<double>(v1x) + v2x + v3x) / 3.0;
-    double pry = (static_cast<double>(v1y) + v2y + v3y) / 3.0;
-
-    const int iterations = 120000;
-    int minX = width, minY = height, maxX = 0, maxY = 0;
-    for (int i = 0; i < iterations; ++i) {
-        int v = rand() % 3;
-        if (v == 0) { prx = (prx + v1x) / 2.0; pry = (pry + v1y) / 2.0; }
-        else if (v == 1) { prx = (prx + v2x) / 2.0; pry = (pry + v2y) / 2.0; }
-        else { prx = (prx + v3x) / 2.0; pry = (pry + v3y) / 2.0; }
-
-        int px = static_cast<int>(std::lround(prx));
-        int py = static_cast<int>(std::lround(pry));
-        if (px >= 0 && px < width && py >= 0 && py < height) {
-            // Golden yellow color for Sierpinski (fractal 2)
-            image.setPixel(px, py, sf::Color(255,215,0));
-            minX = std::min(minX, px); maxX = std::max(maxX, px);
-            minY = std::min(minY, py); maxY = std::max(maxY, py);
+    clearImage(image, width, height, sf::Color::Black);
+    // world triangle (initial view corners), mapped to pixel space
+    constexpr double TRI_LEFT = -2.5, TRI_RIGHT = 1.0, TRI_TOP = 1.0, TRI_BOTTOM = -1.0;
+    const double sx = (width - 1) / (realMax - realMin);
+    const double sy = (height - 1) / (imagMax - imagMin);
+    auto px = [&](double re) { return (re - realMin) * sx; };
+    auto py = [&](double im) { return (imagMax - im) * sy; };
+    const SierpinskiTri root = {px(TRI_LEFT), py(TRI_TOP), px(TRI_RIGHT), py(TRI_TOP),
+                                px((TRI_LEFT + TRI_RIGHT) / 2.0), py(TRI_BOTTOM)};
+
+    // expand the visible top of the tree breadth-first into shareable subtrees
+    const int workers = WorkerPool::shared().size();
+    static thread_local std::vector<SierpinskiTri> frontier, next;
+    frontier.assign(1, root);
+    int depth = 0;
+    while (!frontier.empty() && static_cast<int>(frontier.size()) < 8 * workers && depth < 16) {
+        next.clear();
+        bool split = false;
+        for (const SierpinskiTri &t : frontier) {
+            if (!sierpinskiVisible(t, width, height)) continue;
+            if (sierpinskiIsPixel(t)) { next.push_back(t); continue; }
+            SierpinskiTri sub[3];
+            sierpinskiSplit(t, sub);
+            next.insert(next.end(), sub, sub + 3);
+            split = true;
         }
+        frontier.swap(next);
+        ++depth;
+        if (!split) break;
     }
-    std::cout << "Sierpinski drawn bounds px=["<<minX<<","<<maxX<<"] py=["<<minY<<","<<maxY<<"]\n";
-}
+
+    static thread_local std::vector<std::vector<uint8_t>> masks;
+    masks.resize(std::min<size_t>(workers, std::max<size_t>(1, frontier.size())));
+    for (auto &m : masks) m.assign(static_cast<size_t>(width) * height, 0);
+    std::atomic<size_t> nextTri(0);
+    std::atomic<uint64_t> visitedTotal(0);
+    auto worker = [&](int index) {
+        uint64_t visited = 0;
+        for (size_t i = nextTri++; i < frontier.size(); i = nextTri++) {
+            sierpinskiRaster(frontier[i], width, height, depth, masks[index].data(), visited);
+        }
+        visitedTotal += visited;
+    };
+    WorkerPool::shared().run(static_cast<int>(masks.size()), worker);
+
+    int minX = width, minY = height, maxX = 0, maxY = 0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const size_t i = static_cast<size_t>(y) * width + x;
+            bool hit = false;
+            for (const auto &m : masks) hit = hit || m[i];
+            if (!hit) continue;
+            // Golden yellow color for Sierpinski (fractal 2)
+            image.setPixel(x, y, sf::Color(255,215,0));
+            minX = std::min(minX, x); maxX = std::max(maxX, x);
+            minY = std::min(minY, y); maxY = std::max(maxY, y);
+        }
+    }
+    std::cout << "Sierpinski subtrees=" << frontier.size() << " triangles=" << visitedTotal
+              << " drawn bounds px=["<<minX<<","<<maxX<<"] py=["<<minY<<","<<maxY<<"]\n";
+}
 
 // Koch curve renderer — operate in pixel space so view transforms (zoom/center)
 // always take effect consistently. We recurse in pixel coordinates (double)
@@ -197,14 +1418,15 @@ void renderKoch(sf::Image &image, int width, int height,
                 double realMin, double realMax,
                 double imagMin, double imagMax) {
     std::cout << "Koch render bounds: ["<<realMin<<","<<realMax<<","<<imagMin<<","<<imagMax<<"]\n";
-    image.create(width, height, sf::Color::Black);
+    clearImage(image, width, height, sf::Color::Black);
     // compute center imaginary coordinate and map endpoints into pixel coordinates
     double centerImag = (imagMin + imagMax) / 2.0;
     // endpoints in pixel space (map from world coordinates)
     std::pair<double,double> a_px = { static_cast<double>(realToPixel(realMin, width, realMin, realMax)), static_cast<double>(imagToPixel(centerImag, height, imagMin, imagMax)) };
     std::pair<double,double> b_px = { static_cast<double>(realToPixel(realMax, width, realMin, realMax)), static_cast<double>(imagToPixel(centerImag, height, imagMin, imagMax)) };
     int depth = 6;
-    std::vector<std::pair<double,double>> pts;
+    static thread_local std::vector<std::pair<double,double>> pts; // reused across frames
+    pts.clear();
     kochRecurse(pts, a_px, b_px, depth);
     pts.push_back(b_px);
     // draw lines using pixel coords already computed
@@ -228,7 +1450,7 @@ void renderMenger(sf::Image &image, int width, int height,
                   double imagMin, double imagMax) {
     std::cout << "Menger render bounds: ["<<realMin<<","<<realMax<<","<<imagMin<<","<<imagMax<<"]\n";
     // Use black background and draw the fractal in silver (light gray)
-    image.create(width, height, sf::Color::Black);
+    clearImage(image, width, height, sf::Color::Black);
     int minX = width, minY = height, maxX = 0, maxY = 0;
     // Use pixel coordinates normalized to 0..1 (left->right, bottom->top)
     // so zoom/center always transforms the result consistently.
@@ -255,116 +1477,2052 @@ void renderMenger(sf::Image &image, int width, int height,
             }
         }
     }
-    std::cout << "Menger drawn bounds px=["<<minX<<","<<maxX<<"] py=["<<minY<<","<<maxY<<"]\n";
+    std::cout << "Menger drawn bounds px=["<<minX<<","<<maxX<<"] py=["<<minY<<","<<maxY<<"]\n";
+}
+
+// Dragon curve using L-system
+std::string dragonLSystem(int depth) {
+    std::string s = "FX";
+    for (int i = 0; i < depth; ++i) {
+        std::string next;
+        for (char c : s) {
+            if (c == 'X') next += "X+YF+";
+            else if (c == 'Y') next += "-FX-Y";
+            else next.push_back(c);
+        }
+        s.swap(next);
+    }
+    return s;
+}
+
+void renderDragon(sf::Image &image, int width, int height,
+                  double realMin, double realMax,
+                  double imagMin, double imagMax) {
+    clearImage(image, width, height, sf::Color::Black);
+    // the L-system string only depends on the depth: expand it once
+    const int depth = 12;
+    static const std::string prog = dragonLSystem(depth);
+    double angle = 0.0;
+    // Use a fixed reference world width so the dragon's geometry doesn't
+    // cancel out when mapped to pixels. This makes the curve scale/translate
+    // correctly as the view (realMin/realMax) changes.
+    constexpr double REF_WORLD_WIDTH = 3.5; // initial world width (INIT_REAL_MAX - INIT_REAL_MIN)
+    double step = (REF_WORLD_WIDTH) / static_cast<double>(width) * 2.0; // ~2 pixels per segment at reference scale
+    double cx = (realMin + realMax) / 2.0;
+    double cy = (imagMin + imagMax) / 2.0;
+    double x = cx - (REF_WORLD_WIDTH) / 4.0;
+    double y = cy;
+
+    // First build the list of complex points for the curve, then map to pixels
+    static thread_local std::vector<std::pair<double,double>> points; // reused across frames
+    points.clear();
+    points.reserve(prog.size());
+    for (char c : prog) {
+        if (c == 'F') {
+            double nx = x + cos(angle) * step;
+            double ny = y + sin(angle) * step;
+            points.emplace_back(x, y);
+            // advance
+            x = nx; y = ny;
+        } else if (c == '+') {
+            angle += PI / 2.0;
+        } else if (c == '-') {
+            angle -= PI / 2.0;
+        }
+    }
+
+    int minX = width, minY = height, maxX = 0, maxY = 0;
+    // map points to pixels and draw lines between successive mapped points
+    for (size_t i = 1; i < points.size(); ++i) {
+        int x0 = realToPixel(points[i-1].first, width, realMin, realMax);
+        int y0 = imagToPixel(points[i-1].second, height, imagMin, imagMax);
+        int x1 = realToPixel(points[i].first, width, realMin, realMax);
+        int y1 = imagToPixel(points[i].second, height, imagMin, imagMax);
+        // color shades of red reminiscent of the China flag
+        double t = static_cast<double>(i) / std::max<size_t>(1, points.size()-1);
+        uint8_t r = static_cast<uint8_t>(std::min(255.0, 120.0 + 135.0 * t));
+        sf::Color col(r, 20, 20);
+        drawLine(image, x0, y0, x1, y1, col);
+        minX = std::min({minX, x0, x1}); maxX = std::max({maxX, x0, x1});
+        minY = std::min({minY, y0, y1}); maxY = std::max({maxY, y0, y1});
+    }
+
+    // Log diagnostic info: step and a few sample mapped pixels to see whether mapping varies
+    std::cout << "Dragon step=" << step << " samples=";
+    for (size_t i = 0; i < points.size() && i < 5; ++i) {
+        int sx = realToPixel(points[i].first, width, realMin, realMax);
+        int sy = imagToPixel(points[i].second, height, imagMin, imagMax);
+        std::cout << "(" << sx << "," << sy << ")";
+        if (i + 1 < points.size() && i + 1 < 5) std::cout << ",";
+    }
+    std::cout << "\n";
+
+    std::cout << "Dragon drawn bounds px=["<<minX<<","<<maxX<<"] py=["<<minY<<","<<maxY<<"]\n";
+}
+
+// Buddhabrot (orbit density). Instead of coloring each c by its escape time,
+// every escaping orbit z_1..z_n is traced and each point it visits gets a hit
+// in a density histogram. Three histograms with different iteration limits
+// become the red, green and blue channels ("nebulabrot").
+//
+// Sampling: c is drawn from [-2,2]^2 through a coarse escape map built once
+// with the Mandelbrot kernel; cells on the set's boundary (where the long,
+// interesting orbits start) are drawn 16x more often than the rest. Each hit
+// is weighted by the inverse of its cell's weight, so the density matches
+// uniform sampling and only the noise changes. Points in the main cardioid and
+// period-2 bulb never escape and are rejected without iterating.
+//
+// Threads trace into private histograms and then add them into the shared
+// histogram with relaxed atomic adds (no lock). The shared histogram keeps
+// accumulating across calls while the view and size stay the same, so a still
+// view sharpens frame by frame; a headless run accumulates a fixed sample count.
+// The viewer accumulates on a background task (follow) and only resolves the
+// histogram on the UI thread.
+struct BuddhabrotEngine {
+    static const int GRID = 256;          // escape map cells per axis over [-2,2]
+    static const int CHANNELS = 3;
+    int limits[CHANNELS] = {5000, 500, 50}; // red, green, blue iteration limits
+
+    int width = 0, height = 0;
+    ViewBounds view;                       // absolute bounds being accumulated
+    std::unique_ptr<std::atomic<uint64_t>[]> hist; // CHANNELS planes of width*height
+    std::vector<std::vector<uint32_t>> privateHist; // per worker, zero between calls
+    std::vector<double> cellCdf;           // cumulative cell weights
+    std::vector<uint8_t> cellWeight;       // 1, 4 or 16
+    std::atomic<uint64_t> samples{0};      // c values drawn since the last reset
+    std::atomic<uint64_t> orbits{0};       // of which escaped and were traced
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    std::atomic<int> passes{0};
+    static constexpr double SEED_MS = 8.0;   // synchronous first pass of a new view
+    static constexpr double SLICE_MS = 10.0; // background pass length (bounds cancel latency)
+
+    size_t plane() const { return static_cast<size_t>(width) * height; }
+
+    void buildEscapeMap() {
+        const int maxLimit = *std::max_element(limits, limits + CHANNELS);
+        const double cell = 4.0 / GRID;
+        std::vector<int> iters(GRID * GRID);
+        std::vector<double> xs(GRID);
+        for (int i = 0; i < GRID; ++i) xs[i] = -2.0 + (i + 0.5) * cell;
+        FractalParams p;
+        for (int j = 0; j < GRID; ++j) {
+            escapeTimeRow(MADELBROT, TIER_DOUBLE, xs.data(), GRID, -2.0 + (j + 0.5) * cell, p, maxLimit,
+                          iters.data() + j * GRID);
+        }
+        cellWeight.assign(GRID * GRID, 1);
+        cellCdf.resize(GRID * GRID);
+        double total = 0.0;
+        for (int j = 0; j < GRID; ++j) {
+            for (int i = 0; i < GRID; ++i) {
+                bool inside = false, outside = false;
+                for (int dj = -1; dj <= 1; ++dj) {
+                    for (int di = -1; di <= 1; ++di) {
+                        int u = std::min(GRID - 1, std::max(0, i + di)), v = std::min(GRID - 1, std::max(0, j + dj));
+                        if (iters[v * GRID + u] >= maxLimit) inside = true; else outside = true;
+                    }
+                }
+                uint8_t w = 1;
+                if (inside && outside) w = 16;             // boundary
+                else if (outside && iters[j * GRID + i] >= 8) w = 4; // slow escapers near it
+                cellWeight[j * GRID + i] = w;
+                total += w;
+                cellCdf[j * GRID + i] = total;
+            }
+        }
+    }
+
+    // Start over when the view or size changed; returns true if it did
+    bool reset(int w, int h, const ViewBounds &v) {
+        if (cellCdf.empty()) buildEscapeMap();
+        if (hist && w == width && h == height && v.realMin == view.realMin && v.realMax == view.realMax &&
+            v.imagMin == view.imagMin && v.imagMax == view.imagMax) return false;
+        if (!hist || w != width || h != height) {
+            width = w; height = h;
+            hist.reset(new std::atomic<uint64_t>[plane() * CHANNELS]);
+            privateHist.clear();
+        }
+        view = v;
+        for (size_t i = 0; i < plane() * CHANNELS; ++i) hist[i].store(0, std::memory_order_relaxed);
+        samples = orbits = 0;
+        passes = 0;
+        return true;
+    }
+
+    // Trace `count` samples, or stop early once `budgetMs` (> 0) has elapsed.
+    // Workers are capped so their private histograms stay within ~512 MB.
+    void accumulate(uint64_t count, double budgetMs) {
+        const size_t privBytes = plane() * CHANNELS * sizeof(uint32_t);
+        int workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        workers = std::max(1, std::min(workers, static_cast<int>((512ull << 20) / std::max<size_t>(1, privBytes))));
+        if (static_cast<int>(privateHist.size()) != workers) privateHist.assign(workers, std::vector<uint32_t>(plane() * CHANNELS, 0));
+
+        const int maxLimit = *std::max_element(limits, limits + CHANNELS);
+        const double cell = 4.0 / GRID;
+        const double total = cellCdf.back();
+        const double sx = (width - 1) / (view.realMax - view.realMin);
+        const double sy = (height - 1) / (view.imagMax - view.imagMin);
+        const uint64_t CHUNK = 4096;
+        std::atomic<uint64_t> nextChunk(0);
+        std::atomic<uint64_t> drawn(0), traced(0);
+        auto t0 = std::chrono::high_resolution_clock::now();
+        const int pass = passes++;
+
+        auto worker = [&](int index) {
+            std::vector<uint32_t> &priv = privateHist[index];
+            static thread_local std::vector<double> orbit;
+            orbit.resize(2 * static_cast<size_t>(maxLimit));
+            std::mt19937_64 rng(seed ^ (static_cast<uint64_t>(pass) << 32) ^ static_cast<uint64_t>(index));
+            std::uniform_real_distribution<double> uni(0.0, 1.0);
+            uint64_t myDrawn = 0, myTraced = 0;
+            for (uint64_t c0 = nextChunk.fetch_add(CHUNK); c0 < count; c0 = nextChunk.fetch_add(CHUNK)) {
+                if (budgetMs > 0.0 && std::chrono::duration<double, std::milli>(
+                        std::chrono::high_resolution_clock::now() - t0).count() > budgetMs) break;
+                const uint64_t n = std::min(CHUNK, count - c0);
+                for (uint64_t s = 0; s < n; ++s) {
+                    size_t k = std::upper_bound(cellCdf.begin(), cellCdf.end(), uni(rng) * total) - cellCdf.begin();
+                    k = std::min(k, cellCdf.size() - 1);
+                    const double cr = -2.0 + (k % GRID + uni(rng)) * cell;
+                    const double ci = -2.0 + (k / GRID + uni(rng)) * cell;
+                    const uint32_t weight = 16 / cellWeight[k];
+                    ++myDrawn;
+                    // main cardioid and period-2 bulb
+                    double q = (cr - 0.25) * (cr - 0.25) + ci * ci;
+                    if (q * (q + (cr - 0.25)) <= 0.25 * ci * ci) continue;
+                    if ((cr + 1.0) * (cr + 1.0) + ci * ci <= 0.0625) continue;
+                    double zr = 0.0, zi = 0.0;
+                    int it = 0;
+                    for (; it < maxLimit; ++it) {
+                        double r2 = zr * zr, i2 = zi * zi;
+                        if (r2 + i2 > 4.0) break;
+                        zi = 2.0 * zr * zi + ci;
+                        zr = r2 - i2 + cr;
+                        orbit[2 * it] = zr; orbit[2 * it + 1] = zi;
+                    }
+                    if (it >= maxLimit) continue; // never escaped: contributes nothing
+                    ++myTraced;
+                    for (int p = 0; p < it; ++p) {
+                        int px = static_cast<int>(std::floor((orbit[2 * p] - view.realMin) * sx + 0.5));
+                        int py = static_cast<int>(std::floor((view.imagMax - orbit[2 * p + 1]) * sy + 0.5));
+                        if (px < 0 || py < 0 || px >= width || py >= height) continue;
+                        size_t idx = static_cast<size_t>(py) * width + px;
+                        for (int ch = 0; ch < CHANNELS; ++ch) {
+                            if (it < limits[ch]) priv[ch * plane() + idx] += weight;
+                        }
+                    }
+                }
+            }
+            // lock-free merge; the private histogram is left zeroed for the next call
+            for (size_t i = 0; i < priv.size(); ++i) {
+                if (priv[i]) { hist[i].fetch_add(priv[i], std::memory_order_relaxed); priv[i] = 0; }
+            }
+            drawn += myDrawn;
+            traced += myTraced;
+        };
+        WorkerPool::shared().run(workers, worker);
+        samples += drawn;
+        orbits += traced;
+    }
+
+    // Viewer: keep accumulating `v` in the background. A new view or size
+    // stops the task, starts over with a short synchronous pass (so the frame
+    // is not black) and hands the rest to the task again.
+    void follow(int w, int h, const ViewBounds &v) {
+        if (task.busy() && w == width && h == height && v.realMin == view.realMin && v.realMax == view.realMax &&
+            v.imagMin == view.imagMin && v.imagMax == view.imagMax) return;
+        task.cancel();
+        if (reset(w, h, v)) accumulate(std::numeric_limits<uint64_t>::max(), SEED_MS);
+        task.start();
+    }
+    void stop() { task.cancel(); }
+
+    // Tone map each channel on its own: sqrt of the density relative to the
+    // channel's brightest pixel, so each iteration limit uses the full range
+    void resolve(sf::Image &image) const {
+        clearImage(image, width, height, sf::Color::Black);
+        uint64_t peak[CHANNELS] = {1, 1, 1};
+        for (int ch = 0; ch < CHANNELS; ++ch) {
+            for (size_t i = 0; i < plane(); ++i) peak[ch] = std::max(peak[ch], hist[ch * plane() + i].load(std::memory_order_relaxed));
+        }
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                size_t i = static_cast<size_t>(y) * width + x;
+                uint8_t v[CHANNELS];
+                for (int ch = 0; ch < CHANNELS; ++ch) {
+                    double d = static_cast<double>(hist[ch * plane() + i].load(std::memory_order_relaxed)) / peak[ch];
+                    v[ch] = static_cast<uint8_t>(std::min(255.0, 255.0 * std::sqrt(d)));
+                }
+                image.setPixel(x, y, sf::Color(v[0], v[1], v[2]));
+            }
+        }
+    }
+
+    void run() {
+        while (!task.cancelled()) accumulate(std::numeric_limits<uint64_t>::max(), SLICE_MS);
+    }
+    // declared last so it is stopped before the histograms are destroyed
+    BackgroundTask task{[](void *c) { static_cast<BuddhabrotEngine *>(c)->run(); }, this};
+};
+
+// Buddhabrot frame: what `engine` has accumulated so far, while it keeps
+// accumulating the view in the background. Without an engine a one-off
+// low-sample image is rendered.
+void renderBuddhabrot(sf::Image &image, int width, int height, const ViewBounds &view, BuddhabrotEngine *engine) {
+    BuddhabrotEngine local;
+    BuddhabrotEngine &e = engine ? *engine : local;
+    if (engine) {
+        e.follow(width, height, view);
+    } else {
+        e.reset(width, height, view);
+        e.accumulate(static_cast<uint64_t>(width) * height, 0.0);
+    }
+    e.resolve(image);
+    std::cout << "Buddhabrot samples=" << e.samples << " orbits=" << e.orbits << " passes=" << e.passes << "\n";
+}
+
+// Renderer registry. Each fractal declares what its renderer can do, and the
+// shared machinery (parallel bands here, the tile cache, posters, zoom
+// keyframes, the overlay) checks capabilities instead of fractal ids.
+enum RendererCaps : unsigned {
+    CAP_PER_PIXEL = 1u << 0,     // a pixel depends only on its complex position: tileable, resamplable
+    CAP_REGION = 1u << 1,        // renders any sub-rectangle of a view exactly as in the full view
+    CAP_DETERMINISTIC = 1u << 2, // the same view always gives the same pixels
+    CAP_ITERATIONS = 1u << 3,    // produces per-pixel iteration counts (recolor, antialias, precision tiers)
+    CAP_CACHEABLE = 1u << 4,     // output is keyed by the view alone (no live parameters)
+    CAP_PROGRESSIVE = 1u << 5,   // keeps refining across frames while the view is still
+    CAP_THREADED = 1u << 6,      // parallelizes internally; do not split it further
+};
+
+// One render call. Bounds are relative to params' origin.
+struct RenderJob {
+    int fractal;
+    sf::Image *image;
+    int width, height;
+    double realMin, realMax, imagMin, imagMax;
+    int maxIter;
+    TileCache *tiles;
+    const FractalParams *params;
+    BuddhabrotEngine *buddha;
+    RenderStats *stats;
+    std::vector<int> *iterations; // base-pass iteration counts out (ITERATIONS renderers)
+    ViewBounds absolute() const {
+        const double oR = params->originR.toDouble(), oI = params->originI.toDouble();
+        return ViewBounds(oR + realMin, oR + realMax, oI + imagMin, oI + imagMax);
+    }
+};
+
+struct FractalRenderer {
+    int id;
+    const char *name;
+    unsigned caps;
+    // rough work estimate in inner-loop steps, used to size parallel work
+    double (*cost)(int width, int height, int maxIter);
+    void (*render)(const RenderJob &job);
+};
+
+inline double escapeTimeCost(int width, int height, int maxIter) { return 0.25 * width * height * maxIter; }
+inline double rasterCost(int width, int height, int) { return static_cast<double>(width) * height; }
+
+inline void renderEscapeTimeJob(const RenderJob &j) {
+    renderEscapeTime(*j.image, j.width, j.height, j.realMin, j.realMax, j.imagMin, j.imagMax, j.maxIter, j.fractal,
+                     *j.params, j.tiles, j.stats, j.iterations);
+}
+
+const FractalRenderer FRACTAL_RENDERERS[] = {
+    {MADELBROT, "MADELBROT", CAP_PER_PIXEL | CAP_REGION | CAP_DETERMINISTIC | CAP_ITERATIONS | CAP_CACHEABLE,
+     escapeTimeCost, renderEscapeTimeJob},
+    {SIERPINSKI, "Sierpinski", CAP_REGION | CAP_DETERMINISTIC | CAP_THREADED, rasterCost,
+     [](const RenderJob &j) { ViewBounds v = j.absolute(); renderSierpinski(*j.image, j.width, j.height, v.realMin, v.realMax, v.imagMin, v.imagMax); }},
+    {KOCH, "Koch", CAP_DETERMINISTIC, rasterCost,
+     [](const RenderJob &j) { ViewBounds v = j.absolute(); renderKoch(*j.image, j.width, j.height, v.realMin, v.realMax, v.imagMin, v.imagMax); }},
+    {MENGER, "Menger", CAP_DETERMINISTIC, [](int w, int h, int) { return 8.0 * w * h; },
+     [](const RenderJob &j) { ViewBounds v = j.absolute(); renderMenger(*j.image, j.width, j.height, v.realMin, v.realMax, v.imagMin, v.imagMax); }},
+    {DRAGON, "Dragon", CAP_DETERMINISTIC, [](int, int, int) { return 4096.0 * 8; },
+     [](const RenderJob &j) { ViewBounds v = j.absolute(); renderDragon(*j.image, j.width, j.height, v.realMin, v.realMax, v.imagMin, v.imagMax); }},
+    {JULIA, "Julia", CAP_PER_PIXEL | CAP_REGION | CAP_DETERMINISTIC | CAP_ITERATIONS, escapeTimeCost, renderEscapeTimeJob},
+    {MULTIBROT3, "Multibrot z^3", CAP_PER_PIXEL | CAP_REGION | CAP_DETERMINISTIC | CAP_ITERATIONS | CAP_CACHEABLE,
+     [](int w, int h, int maxIter) { return 1.5 * escapeTimeCost(w, h, maxIter); }, renderEscapeTimeJob},
+    {BURNING_SHIP, "Burning Ship", CAP_PER_PIXEL | CAP_REGION | CAP_DETERMINISTIC | CAP_ITERATIONS | CAP_CACHEABLE,
+     escapeTimeCost, renderEscapeTimeJob},
+    {BUDDHABROT, "Buddhabrot", CAP_PROGRESSIVE | CAP_THREADED, [](int w, int h, int) { return 40.0 * w * h; },
+     [](const RenderJob &j) { renderBuddhabrot(*j.image, j.width, j.height, j.absolute(), j.buddha); }},
+};
+
+// Renderer for a fractal id; unknown ids fall back to Mandelbrot
+inline const FractalRenderer &findRenderer(int fractal) {
+    for (const FractalRenderer &r : FRACTAL_RENDERERS) {
+        if (r.id == fractal) return r;
+    }
+    return FRACTAL_RENDERERS[0];
+}
+
+inline bool isRegisteredFractal(int fractal) {
+    for (const FractalRenderer &r : FRACTAL_RENDERERS) {
+        if (r.id == fractal) return true;
+    }
+    return false;
+}
+
+inline bool rendererHas(int fractal, unsigned caps) { return (findRenderer(fractal).caps & caps) == caps; }
+
+// Ids of the fractals whose renderers have all of `caps`, e.g. "1, 6, 7, 8", for messages
+inline std::string fractalsWith(unsigned caps) {
+    std::string list;
+    for (const FractalRenderer &r : FRACTAL_RENDERERS) {
+        if ((r.caps & caps) != caps) continue;
+        if (!list.empty()) list += ", ";
+        list += std::to_string(r.id);
+    }
+    return list;
+}
+
+// Master dispatcher. Region-capable renderers whose estimated cost is worth
+// it are split into horizontal bands rendered on parallel threads (each band
+// gets one extra row above and below so neighbourhood passes like antialiasing
+// see the same pixels as in a full-frame render). maxThreads = 0 uses every
+// core; callers that already run in parallel pass 1. `iterations`, when
+// given, receives the base-pass iteration counts of ITERATIONS renderers.
+void renderCurrent(int fractal, sf::Image &image, int width, int height,
+                   double realMin, double realMax, double imagMin, double imagMax, int maxIter,
+                   TileCache *tiles = nullptr, const FractalParams &params = FractalParams(),
+                   BuddhabrotEngine *buddha = nullptr, RenderStats *stats = nullptr, int maxThreads = 0,
+                   std::vector<int> *iterations = nullptr) {
+    std::cout << "renderCurrent called: fractal=" << fractal
+              << " bounds=[" << realMin << "," << realMax << "," << imagMin << "," << imagMax << "]\n";
+    const FractalRenderer &r = findRenderer(fractal);
+    RenderJob job = {r.id, &image, width, height, realMin, realMax, imagMin, imagMax, maxIter,
+                     (r.caps & CAP_CACHEABLE) ? tiles : nullptr, &params, buddha, stats,
+                     (r.caps & CAP_ITERATIONS) ? iterations : nullptr};
+
+    const double MIN_BAND_COST = 2e6; // below this a thread costs more than it saves
+    // A few bands per pool thread (of at least 32 rows), so a render that
+    // starts while a background batch occupies the workers gets them back
+    // at band boundaries; an explicit maxThreads gives one band per thread
+    const int threads = WorkerPool::shared().size();
+    int bands = maxThreads > 0 ? maxThreads : std::min(4 * threads, std::max(threads, height / 32));
+    bands = std::min(bands, static_cast<int>(r.cost(width, height, maxIter) / MIN_BAND_COST));
+    bands = std::min(bands, height / 8);
+    if (!(r.caps & CAP_REGION) || (r.caps & CAP_THREADED) || bands < 2) {
+        r.render(job);
+        return;
+    }
+
+    if (image.getSize().x != static_cast<unsigned>(width) || image.getSize().y != static_cast<unsigned>(height)) {
+        image.create(width, height, sf::Color::Black);
+    }
+    // per-thread band buffers and stats slots are reused from frame to frame
+    static thread_local std::vector<RenderStats> bandStats;
+    bandStats.assign(bands, RenderStats());
+    if (job.iterations) job.iterations->assign(static_cast<size_t>(width) * height, 0);
+    auto renderBand = [&](int b) {
+        const int y0 = b * height / bands, y1 = (b + 1) * height / bands;  // rows [y0, y1)
+        const int r0 = std::max(0, y0 - 1), r1 = std::min(height, y1 + 1); // with overlap
+        static thread_local sf::Image band;
+        clearImage(band, width, r1 - r0, sf::Color::Black);
+        RenderJob bj = job;
+        bj.image = &band;
+        bj.height = r1 - r0;
+        bj.imagMax = pixelToImag(r0, height, imagMin, imagMax);
+        bj.imagMin = pixelToImag(r1 - 1, height, imagMin, imagMax);
+        bj.stats = stats ? &bandStats[b] : nullptr;
+        static thread_local std::vector<int> bandIters;
+        bj.iterations = job.iterations ? &bandIters : nullptr;
+        r.render(bj);
+        if (job.iterations) {
+            std::copy(bandIters.begin() + static_cast<size_t>(y0 - r0) * width,
+                      bandIters.begin() + static_cast<size_t>(y1 - r0) * width,
+                      job.iterations->begin() + static_cast<size_t>(y0) * width);
+        }
+        // bands write disjoint rows of the already-sized image
+        image.copy(band, 0, y0, sf::IntRect(0, y0 - r0, width, y1 - y0));
+    };
+    WorkerPool::shared().run(bands, renderBand);
+    if (stats) {
+        for (const RenderStats &s : bandStats) {
+            stats->basePixels += s.basePixels; stats->aaPixels += s.aaPixels; stats->aaSamples += s.aaSamples;
+        }
+    }
+}
+
+// RGBA -> planar YUV 4:2:0 (BT.601 full range, matching Y4M "C420jpeg").
+// Fixed-point integer math over whole rows with no data-dependent branches so
+// the compiler can vectorize the inner loops.
+inline uint8_t clampByte(int v) { return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v)); }
+
+void rgbaToI420(const uint8_t *rgba, int width, int height, uint8_t *yPlane, uint8_t *uPlane, uint8_t *vPlane) {
+    const size_t stride = static_cast<size_t>(width) * 4;
+    for (int row = 0; row < height; ++row) {
+        const uint8_t *src = rgba + static_cast<size_t>(row) * stride;
+        uint8_t *dst = yPlane + static_cast<size_t>(row) * width;
+        for (int x = 0; x < width; ++x) {
+            int r = src[4 * x], g = src[4 * x + 1], b = src[4 * x + 2];
+            dst[x] = static_cast<uint8_t>((77 * r + 150 * g + 29 * b + 128) >> 8);
+        }
+    }
+    const int cw = (width + 1) / 2;
+    const int ch = (height + 1) / 2;
+    for (int cy = 0; cy < ch; ++cy) {
+        const uint8_t *row0 = rgba + static_cast<size_t>(2 * cy) * stride;
+        const uint8_t *row1 = rgba + static_cast<size_t>(std::min(2 * cy + 1, height - 1)) * stride;
+        uint8_t *du = uPlane + static_cast<size_t>(cy) * cw;
+        uint8_t *dv = vPlane + static_cast<size_t>(cy) * cw;
+        for (int cx = 0; cx < cw; ++cx) {
+            const int x0 = 4 * (2 * cx);
+            const int x1 = 4 * std::min(2 * cx + 1, width - 1);
+            int r = (row0[x0] + row0[x1] + row1[x0] + row1[x1] + 2) >> 2;
+            int g = (row0[x0 + 1] + row0[x1 + 1] + row1[x0 + 1] + row1[x1 + 1] + 2) >> 2;
+            int b = (row0[x0 + 2] + row0[x1 + 2] + row1[x0 + 2] + row1[x1 + 2] + 2) >> 2;
+            du[cx] = clampByte(((-43 * r - 85 * g + 128 * b + 128) >> 8) + 128);
+            dv[cx] = clampByte(((128 * r - 107 * g - 21 * b + 128) >> 8) + 128);
+        }
+    }
+}
+
+// Raw video output: writes rendered frames as Y4M or raw RGBA to stdout, a file
+// or a FIFO so an encoder can consume them directly, e.g.
+//   FractalApp --stream y4m | ffmpeg -i - zoom.mp4
+// push() converts straight from the image pixels into a pooled output buffer
+// and hands it to a writer thread. At most `maxQueued` frames may be waiting;
+// beyond that push() blocks, so rendering runs ahead of the encoder by a
+// bounded amount instead of buffering without limit.
+struct FrameStream {
+    enum Format { Y4M, RAW_RGBA };
+    Format format = Y4M;
+    int width = 0, height = 0;
+    size_t frameBytes = 0;
+    FILE *out = nullptr;
+    bool ownsFile = false;
+    size_t maxQueued = 4;
+    size_t allocated = 0; // buffers created so far (pool grows up to maxQueued + 1)
+    std::mutex m;
+    std::condition_variable cv;
+    std::queue<std::vector<uint8_t>> pending;   // converted frames waiting for the writer
+    std::vector<std::vector<uint8_t>> freeBufs; // recycled frame buffers
+    bool stopping = false;
+    bool failed = false;
+    std::thread writer;
+    uint64_t framesPushed = 0;
+    std::atomic<uint64_t> framesWritten{0};
+    double blockedMs = 0.0; // total time push() waited on the encoder
+
+    // early exits of main never leave the writer thread joinable
+    ~FrameStream() { close(); }
+
+    bool isOpen() const { return out != nullptr; }
+
+    bool open(const std::string &path, Format fmt, int w, int h, int fps, int queueDepth) {
+        format = fmt; width = w; height = h;
+        maxQueued = static_cast<size_t>(std::max(1, queueDepth));
+        const size_t pixels = static_cast<size_t>(w) * h;
+        const size_t chroma = static_cast<size_t>((w + 1) / 2) * ((h + 1) / 2);
+        frameBytes = (fmt == Y4M) ? pixels + 2 * chroma : pixels * 4;
+        if (path == "-") {
+#ifdef _WIN32
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            out = stdout; ownsFile = false;
+        } else {
+            out = std::fopen(path.c_str(), "wb");
+            ownsFile = true;
+            if (!out) { std::cerr << "FrameStream: cannot open " << path << "\n"; return false; }
+        }
+        if (fmt == Y4M) {
+            std::fprintf(out, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", w, h, fps);
+        }
+        writer = std::thread([this]() { writerLoop(); });
+        return true;
+    }
+
+    void writerLoop() {
+        while (true) {
+            std::vector<uint8_t> buf;
+            {
+                std::unique_lock<std::mutex> lk(m);
+                cv.wait(lk, [&]{ return !pending.empty() || stopping; });
+                if (pending.empty()) break;
+                buf = std::move(pending.front()); pending.pop();
+            }
+            bool ok = true;
+            if (format == Y4M) ok = std::fwrite("FRAME\n", 1, 6, out) == 6;
+            ok = ok && std::fwrite(buf.data(), 1, buf.size(), out) == buf.size();
+            {
+                std::lock_guard<std::mutex> lk(m);
+                if (!ok) failed = true; // encoder went away; push() becomes a no-op
+                freeBufs.push_back(std::move(buf));
+            }
+            if (ok) framesWritten++;
+            cv.notify_all();
+        }
+        std::fflush(out);
+    }
+
+    // Convert and enqueue one frame; blocks while the queue is full.
+    void push(const sf::Image &img) {
+        if (!out) return;
+        const sf::Uint8 *px = img.getPixelsPtr();
+        if (!px || static_cast<int>(img.getSize().x) != width || static_cast<int>(img.getSize().y) != height) return;
+        std::vector<uint8_t> buf;
+        {
+            auto waitStart = std::chrono::high_resolution_clock::now();
+            std::unique_lock<std::mutex> lk(m);
+            cv.wait(lk, [&]{ return failed || (pending.size() < maxQueued && (!freeBufs.empty() || allocated <= maxQueued)); });
+            blockedMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - waitStart).count();
+            if (failed) return;
+            if (!freeBufs.empty()) { buf = std::move(freeBufs.back()); freeBufs.pop_back(); }
+            else allocated++;
+        }
+        buf.resize(frameBytes);
+        if (format == Y4M) {
+            const size_t ySize = static_cast<size_t>(width) * height;
+            const size_t cSize = static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+            rgbaToI420(px, width, height, buf.data(), buf.data() + ySize, buf.data() + ySize + cSize);
+        } else {
+            std::memcpy(buf.data(), px, frameBytes);
+        }
+        {
+            std::lock_guard<std::mutex> lk(m);
+            pending.push(std::move(buf));
+        }
+        framesPushed++;
+        cv.notify_all();
+    }
+
+    void close() {
+        if (!out) return;
+        {
+            std::lock_guard<std::mutex> lk(m);
+            stopping = true;
+        }
+        cv.notify_all();
+        if (writer.joinable()) writer.join();
+        if (ownsFile) std::fclose(out);
+        out = nullptr;
+    }
+};
+
+// ln(target width / start width) of a zoom; 0 when either width is degenerate
+inline double zoomLogRatio(const ViewBounds &start, const ViewBounds &target) {
+    double startW = start.realMax - start.realMin;
+    double targetW = target.realMax - target.realMin;
+    return (startW > 0.0 && targetW > 0.0) ? std::log(targetW / startW) : 0.0;
+}
+
+// Share of the center's move done at progress p. The center moves in step
+// with the width (not linearly in p), so the point the zoom closes in on
+// keeps its place on screen, e.g. the cursor of a wheel zoom; a pan
+// (logRatio 0) moves linearly.
+inline double zoomCenterShare(double p, double logRatio) {
+    return logRatio != 0.0 ? std::expm1(p * logRatio) / std::expm1(logRatio) : p;
+}
+
+// View at progress p (0..1) along a zoom: width interpolates exponentially
+// for a natural zoom and the center follows zoomCenterShare. Used by
+// ZoomAnim, the precache and the keyframe sequence so they all agree on the path.
+ViewBounds zoomPathView(const ViewBounds &start, const ViewBounds &target, double p, int width, int height) {
+    double startW = start.realMax - start.realMin;
+    double targetW = target.realMax - target.realMin;
+    double curW = 0.0;
+    const double logRatio = zoomLogRatio(start, target);
+    if (startW > 0.0 && targetW > 0.0) curW = startW * std::exp(p * logRatio);
+    else curW = start.realMax + (target.realMax - start.realMax) * p;
+    const double share = zoomCenterShare(p, logRatio);
+    double startCenterR = (start.realMin + start.realMax) / 2.0;
+    double targetCenterR = (target.realMin + target.realMax) / 2.0;
+    double centerR = startCenterR + (targetCenterR - startCenterR) * share;
+    double startCenterI = (start.imagMin + start.imagMax) / 2.0;
+    double targetCenterI = (target.imagMin + target.imagMax) / 2.0;
+    double centerI = startCenterI + (targetCenterI - startCenterI) * share;
+    double halfW = curW / 2.0;
+    double halfH = curW * (static_cast<double>(height) / static_cast<double>(width)) / 2.0;
+    return ViewBounds(centerR - halfW, centerR + halfW, centerI - halfH, centerI + halfH);
+}
+
+// Path progress at time fraction u of a zoom animation: a cubic that starts
+// with slope v0 (progress per unit of u) and comes to rest at the target.
+// v0 is kept within [0, 3], where the curve is monotonic.
+inline double zoomEase(double u, double v0) {
+    if (u >= 1.0) return 1.0;
+    if (u <= 0.0) return 0.0;
+    return ((v0 - 2.0) * u + (3.0 - 2.0 * v0)) * u * u + v0 * u;
+}
+inline double zoomEaseSlope(double u, double v0) {
+    u = std::max(0.0, std::min(1.0, u));
+    return (3.0 * (v0 - 2.0) * u + 2.0 * (3.0 - 2.0 * v0)) * u + v0;
+}
+
+// Direction of zoomPathView at progress p, per unit of p, in path
+// coordinates: log2 of the width and the center in units of `unit` (a
+// width, so pans and zooms compare)
+inline void zoomPathTangent(const ViewBounds &start, const ViewBounds &target, double p, double unit, double out[3]) {
+    const double logRatio = zoomLogRatio(start, target);
+    const double shareRate = logRatio != 0.0 ? logRatio * std::exp(p * logRatio) / std::expm1(logRatio) : 1.0;
+    out[0] = logRatio / std::log(2.0);
+    out[1] = ((target.realMin + target.realMax) - (start.realMin + start.realMax)) / (2.0 * unit) * shareRate;
+    out[2] = ((target.imagMin + target.imagMax) - (start.imagMin + start.imagMax)) / (2.0 * unit) * shareRate;
+}
+
+// Initial slope for a new path from `from` to `to` lasting `duration`
+// seconds that continues `velocity` (path coordinates per second): the
+// velocity's component along the new path, so a retargeted zoom keeps its
+// speed instead of restarting from rest
+inline double zoomRetargetSlope(const double velocity[3], const ViewBounds &from, const ViewBounds &to, double duration) {
+    double d[3];
+    zoomPathTangent(from, to, 0.0, from.realMax - from.realMin, d);
+    double dot = 0.0, len2 = 0.0;
+    for (int k = 0; k < 3; ++k) {
+        dot += velocity[k] * d[k];
+        len2 += d[k] * d[k];
+    }
+    if (len2 <= 0.0) return 0.0;
+    return std::max(0.0, std::min(3.0, dot / len2 * duration));
+}
+
+// Keyframe zoom renderer: instead of rendering every intermediate view of a
+// zoom, render one oversized keyframe per octave (factor-of-2 width change)
+// and resample the frames in between. Keyframe k covers every view of its
+// segment of the path at the pixel spacing of the smallest of them, so
+// frames are only ever downsampled. Near the end of a segment the next
+// keyframe is blended in where it covers the frame, which hides the switch.
+// While the zoom target is on screen an octave's views nest, so a keyframe
+// is about twice the output size per axis; when it is not, octaves are split
+// into more segments until every keyframe fits within 4x the output.
+// Only valid for renderers whose output is a function of complex position
+// (the escape-time fractals); the others draw in screen space.
+struct ZoomSequence {
+    struct Keyframe {
+        ViewBounds bounds;
+        double spacingR = 0.0, spacingI = 0.0;
+        sf::Image image;
+        bool rendered = false;
+    };
+    ViewBounds start, target;
+    int outW = 0, outH = 0, fractal = 1, maxIter = 0;
+    FractalParams params;
+    int octaves = 1;                 // factor-of-2 width changes along the path
+    int segments = 1;                // keyframes: octaves, split further if needed
+    std::vector<Keyframe> keyframes; // one per segment, rendered lazily
+    uint64_t keyframePixels = 0;     // fractal samples computed so far
+    uint64_t framePixels = 0;        // output pixels synthesized so far
+
+    void init(const ViewBounds &s, const ViewBounds &t, int w, int h, int frac, int iter,
+              const FractalParams &fp = FractalParams()) {
+        start = s; target = t; outW = w; outH = h; fractal = frac; maxIter = iter; params = fp;
+        double startW = s.realMax - s.realMin;
+        double targetW = t.realMax - t.realMin;
+        double ratio = (startW > 0.0 && targetW > 0.0) ? std::fabs(std::log2(startW / targetW)) : 0.0;
+        octaves = std::max(1, static_cast<int>(std::ceil(ratio - 1e-9)));
+        segments = octaves;
+        while (!fitsCap() && segments < 64 * octaves) segments *= 2;
+        if (!fitsCap()) {
+            std::cerr << "Zoom keyframes: path too wide for " << segments
+                      << " keyframes, frames will be under-resolved\n";
+        }
+        // keyframe slots keep their pixel storage when the sequence is reused
+        keyframes.resize(segments);
+        for (Keyframe &kf : keyframes) kf.rendered = false;
+        keyframePixels = 0; framePixels = 0;
+    }
+
+    // Size in pixels, with one pixel of margin for bilinear taps, of the box
+    // around the views at segment boundaries k and k+1, sampled at the
+    // spacing of the smaller one. Every edge of a path view is an affine
+    // function of its width, so the box of the two end views covers the
+    // whole segment.
+    void segmentBox(int k, ViewBounds &box, double &spacingR, double &spacingI, double &kw, double &kh) const {
+        ViewBounds a = zoomPathView(start, target, static_cast<double>(k) / segments, outW, outH);
+        ViewBounds b = zoomPathView(start, target, static_cast<double>(k + 1) / segments, outW, outH);
+        spacingR = std::min(a.realMax - a.realMin, b.realMax - b.realMin) / (outW - 1);
+        spacingI = std::min(a.imagMax - a.imagMin, b.imagMax - b.imagMin) / (outH - 1);
+        box = ViewBounds(std::min(a.realMin, b.realMin), std::max(a.realMax, b.realMax),
+                         std::min(a.imagMin, b.imagMin), std::max(a.imagMax, b.imagMax));
+        kw = std::ceil((box.realMax - box.realMin) / spacingR) + 3;
+        kh = std::ceil((box.imagMax - box.imagMin) / spacingI) + 3;
+    }
+    bool fitsCap() const {
+        for (int k = 0; k < segments; ++k) {
+            ViewBounds box;
+            double sr, si, kw, kh;
+            segmentBox(k, box, sr, si, kw, kh);
+            if (kw > 4.0 * outW || kh > 4.0 * outH) return false;
+        }
+        return true;
+    }
+
+    // Render keyframe k covering the views at segment boundaries k and k+1
+    Keyframe &keyframe(int k) {
+        Keyframe &kf = keyframes[k];
+        if (kf.rendered) return kf;
+        ViewBounds box;
+        double boxW, boxH;
+        segmentBox(k, box, kf.spacingR, kf.spacingI, boxW, boxH);
+        const double rmin = box.realMin, rmax = box.realMax, imin = box.imagMin, imax = box.imagMax;
+        // capped at 4x the output size per axis; init split the path so that
+        // only a path it reported as too wide gets here with a larger box
+        int kw = static_cast<int>(std::min(4.0 * outW, boxW));
+        int kh = static_cast<int>(std::min(4.0 * outH, boxH));
+        kf.spacingR = std::max(kf.spacingR, (rmax - rmin) / (kw - 3));
+        kf.spacingI = std::max(kf.spacingI, (imax - imin) / (kh - 3));
+        kf.bounds = ViewBounds(rmin - kf.spacingR, rmin + (kw - 2) * kf.spacingR,
+                               imax - (kh - 2) * kf.spacingI, imax + kf.spacingI);
+        clearImage(kf.image, kw, kh, sf::Color::Black);
+        renderCurrent(fractal, kf.image, kw, kh, kf.bounds.realMin, kf.bounds.realMax,
+                      kf.bounds.imagMin, kf.bounds.imagMax, maxIter, nullptr, params);
+        keyframePixels += static_cast<uint64_t>(kw) * kh;
+        kf.rendered = true;
+        return kf;
+    }
+
+    // Drop keyframes before k to bound memory on long paths
+    void release(int k) {
+        for (int i = 0; i < k && i < segments; ++i) {
+            if (keyframes[i].rendered) { keyframes[i].image = sf::Image(); keyframes[i].rendered = false; }
+        }
+    }
+
+    // Bilinear sample at keyframe pixel position (fx, fy); false if outside
+    static bool sample(const Keyframe &kf, double fx, double fy, float rgb[3]) {
+        const sf::Vector2u size = kf.image.getSize();
+        if (fx < 0.0 || fy < 0.0 || fx > size.x - 1.0 || fy > size.y - 1.0) return false;
+        int x0 = std::min(static_cast<int>(fx), static_cast<int>(size.x) - 2);
+        int y0 = std::min(static_cast<int>(fy), static_cast<int>(size.y) - 2);
+        float tx = static_cast<float>(fx - x0), ty = static_cast<float>(fy - y0);
+        const sf::Uint8 *px = kf.image.getPixelsPtr();
+        const size_t stride = static_cast<size_t>(size.x) * 4;
+        const sf::Uint8 *p00 = px + y0 * stride + x0 * 4;
+        const sf::Uint8 *p10 = p00 + 4;
+        const sf::Uint8 *p01 = p00 + stride;
+        const sf::Uint8 *p11 = p01 + 4;
+        for (int c = 0; c < 3; ++c) {
+            float top = p00[c] + (p10[c] - p00[c]) * tx;
+            float bot = p01[c] + (p11[c] - p01[c]) * tx;
+            rgb[c] = top + (bot - top) * ty;
+        }
+        return true;
+    }
+
+    // Average of four bilinear taps spread over the output pixel footprint
+    static bool sampleFootprint(const Keyframe &kf, double r, double i, double footR, double footI, float rgb[3]) {
+        const double fx = (r - kf.bounds.realMin) / kf.spacingR;
+        const double fy = (kf.bounds.imagMax - i) / kf.spacingI;
+        const double ox = 0.25 * footR / kf.spacingR;
+        const double oy = 0.25 * footI / kf.spacingI;
+        float acc[3] = {0.f, 0.f, 0.f}, tap[3];
+        const double dx[4] = {-ox, ox, -ox, ox}, dy[4] = {-oy, -oy, oy, oy};
+        for (int t = 0; t < 4; ++t) {
+            if (!sample(kf, fx + dx[t], fy + dy[t], tap)) return false;
+            acc[0] += tap[0]; acc[1] += tap[1]; acc[2] += tap[2];
+        }
+        rgb[0] = acc[0] * 0.25f; rgb[1] = acc[1] * 0.25f; rgb[2] = acc[2] * 0.25f;
+        return true;
+    }
+
+    // Synthesize the frame at path progress p (0..1) into `out`
+    void renderFrame(double p, sf::Image &out) {
+        p = std::max(0.0, std::min(1.0, p));
+        const double pos = p * segments;
+        const int k = std::min(segments - 1, static_cast<int>(std::floor(pos)));
+        const float blend = static_cast<float>(pos - k); // weight of keyframe k+1
+        const Keyframe &cur = keyframe(k);
+        const Keyframe *next = (k + 1 < segments && blend > 0.0f) ? &keyframe(k + 1) : nullptr;
+        const ViewBounds v = zoomPathView(start, target, p, outW, outH);
+        const double footR = (v.realMax - v.realMin) / (outW - 1);
+        const double footI = (v.imagMax - v.imagMin) / (outH - 1);
+        if (out.getSize().x != static_cast<unsigned>(outW) || out.getSize().y != static_cast<unsigned>(outH))
+            out.create(outW, outH, sf::Color::Black);
+        for (int y = 0; y < outH; ++y) {
+            const double im = pixelToImag(y, outH, v.imagMin, v.imagMax);
+            for (int x = 0; x < outW; ++x) {
+                const double re = pixelToReal(x, outW, v.realMin, v.realMax);
+                float a[3] = {0.f, 0.f, 0.f}, b[3];
+                sampleFootprint(cur, re, im, footR, footI, a);
+                if (next && sampleFootprint(*next, re, im, footR, footI, b)) {
+                    for (int c = 0; c < 3; ++c) a[c] += (b[c] - a[c]) * blend;
+                }
+                out.setPixel(x, y, sf::Color(static_cast<sf::Uint8>(a[0] + 0.5f),
+                                             static_cast<sf::Uint8>(a[1] + 0.5f),
+                                             static_cast<sf::Uint8>(a[2] + 0.5f)));
+            }
+        }
+        framePixels += static_cast<uint64_t>(outW) * outH;
+        release(k);
+    }
+};
+
+// Headless zoom video: render `frames` frames from `start` to `target` via
+// keyframes and push them to the frame stream. Both views are relative to
+// the origin in params.
+void renderZoomVideo(FrameStream &stream, int fractal, const ViewBounds &start, const ViewBounds &target,
+                     int frames, int width, int height, int maxIter, const FractalParams &params) {
+    ZoomSequence seq;
+    seq.init(start, target, width, height, fractal, maxIter, params);
+    sf::Image frame;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        double p = frames > 1 ? static_cast<double>(i) / (frames - 1) : 1.0;
+        seq.renderFrame(p, frame);
+        stream.push(frame);
+        if ((i + 1) % 60 == 0 || i + 1 == frames) {
+            double s = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+            std::cerr << "Zoom video frame " << (i + 1) << "/" << frames << " keyframes=" << seq.segments
+                      << " computed_px=" << seq.keyframePixels << " output_px=" << seq.framePixels
+                      << " elapsed_s=" << s << "\n";
+        }
+    }
+}
+
+// Last completed escape-time frame: its base-pass iteration counts and what
+// they were computed for. Zoom reprojection reads from it.
+struct IterationFrame {
+    int fractal = 0, maxIter = 0, width = 0, height = 0, tier = 0;
+    ViewBounds view;                 // relative to params' origin
+    FractalParams params;
+    std::vector<int> iters;
+
+    bool valid() const { return !iters.empty() && iters.size() == static_cast<size_t>(width) * height; }
+    // same fractal, iteration limit, origin and (for Julia) constant
+    bool compatible(int f, int mi, const FractalParams &p) const {
+        return valid() && f == fractal && mi == maxIter &&
+               p.originR.hi == params.originR.hi && p.originR.lo == params.originR.lo &&
+               p.originI.hi == params.originI.hi && p.originI.lo == params.originI.lo &&
+               (f != JULIA || (p.juliaRe == params.juliaRe && p.juliaIm == params.juliaIm));
+    }
+    void describe(int f, int mi, int w, int h, const ViewBounds &v, const FractalParams &p) {
+        fractal = f; maxIter = mi; width = w; height = h; view = v; params = p;
+        tier = escapePrecisionTier(v.realMin, v.realMax, v.imagMin, v.imagMax, w, h);
+    }
+};
+
+// Map target pixels along one axis onto source pixels. Positions are
+// start + i * step on both sides; idx is the nearest source pixel (-1 when
+// outside the source) and exact marks target samples that land on a source
+// sample, e.g. every other pixel of a 2x zoom about a pixel. "Land on" means
+// within REUSE_TOLERANCE of a source pixel: the two grids compute the same
+// point with different roundings, so exact equality of coordinates would
+// reject about a third of these samples.
+const double REUSE_TOLERANCE = 1e-6; // pixels
+inline void reprojectAxis(int n, double tStart, double tStep, int sn, double sStart, double sStep,
+                          std::vector<int> &idx, std::vector<uint8_t> &exact) {
+    idx.resize(n);
+    exact.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const double f = (tStart + i * tStep - sStart) / sStep;
+        const double k = std::floor(f + 0.5);
+        const bool inside = k >= 0.0 && k < sn;
+        idx[i] = inside ? static_cast<int>(k) : -1;
+        exact[i] = inside && std::fabs(f - k) < REUSE_TOLERANCE;
+    }
+}
+
+// Instant zoom preview: the last completed frame warped to `view`
+// (nearest-neighbour over its iteration counts). Areas the source does not
+// cover, when zooming out, stay black. Returns the number of pixels whose
+// value is exact rather than approximate.
+uint64_t reprojectPreview(const IterationFrame &src, const ViewBounds &view, int width, int height, sf::Image &out) {
+    // index and flag buffers are reused from frame to frame
+    static thread_local std::vector<int> xi, yi;
+    static thread_local std::vector<uint8_t> xe, ye;
+    reprojectAxis(width, view.realMin, (view.realMax - view.realMin) / (width - 1), src.width,
+                  src.view.realMin, (src.view.realMax - src.view.realMin) / (src.width - 1), xi, xe);
+    reprojectAxis(height, view.imagMax, -(view.imagMax - view.imagMin) / (height - 1), src.height,
+                  src.view.imagMax, -(src.view.imagMax - src.view.imagMin) / (src.height - 1), yi, ye);
+    uint64_t exact = 0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (yi[y] < 0 || xi[x] < 0) { out.setPixel(x, y, sf::Color::Black); continue; }
+            const int it = src.iters[static_cast<size_t>(yi[y]) * src.width + xi[x]];
+            out.setPixel(x, y, escapeColor(src.fractal, it, src.maxIter));
+            exact += ye[y] && xe[x];
+        }
+    }
+    return exact;
+}
+
+// Background completion of a zoom target. Samples that coincide with the last
+// completed frame (same tier, within REUSE_TOLERANCE) are copied. A copied
+// count was computed up to that far from the target position, so it can
+// differ from a fresh one only where an escape-count boundary passes between
+// the two points: about 1 pixel in 20000 for 2x zooms about a pixel, close to
+// the rate at which banded and single-threaded renders differ. A background
+// task computes the rest row by row and can be cancelled between rows. When
+// done, the main loop shows the target from these counts instead of rendering it.
+struct ZoomCompletion {
+    std::atomic<bool> done{false};
+    IterationFrame frame;
+    uint64_t reused = 0;
+    uint64_t computed = 0;
+    std::vector<double> xs;     // row scratch, kept across zooms
+    std::vector<int> cols, out;
+    BackgroundTask task{[](void *c) { static_cast<ZoomCompletion *>(c)->compute(); }, this};
+
+    void stop() {
+        task.cancel();
+        done = false;
+    }
+
+    void start(const IterationFrame &src, int fractal, int maxIter, const ViewBounds &target,
+               int width, int height, const FractalParams &params) {
+        stop();
+        frame.describe(fractal, maxIter, width, height, target, params);
+        frame.iters.assign(static_cast<size_t>(width) * height, -1);
+        reused = computed = 0;
+        if (src.compatible(fractal, maxIter, params) && src.tier == frame.tier) {
+            static thread_local std::vector<int> xi, yi;
+            static thread_local std::vector<uint8_t> xe, ye;
+            reprojectAxis(width, target.realMin, (target.realMax - target.realMin) / (width - 1), src.width,
+                          src.view.realMin, (src.view.realMax - src.view.realMin) / (src.width - 1), xi, xe);
+            reprojectAxis(height, target.imagMax, -(target.imagMax - target.imagMin) / (height - 1), src.height,
+                          src.view.imagMax, -(src.view.imagMax - src.view.imagMin) / (src.height - 1), yi, ye);
+            for (int y = 0; y < height; ++y) {
+                if (!ye[y]) continue;
+                for (int x = 0; x < width; ++x) {
+                    if (!xe[x]) continue;
+                    frame.iters[static_cast<size_t>(y) * width + x] = src.iters[static_cast<size_t>(yi[y]) * src.width + xi[x]];
+                    ++reused;
+                }
+            }
+        }
+        task.start();
+    }
+
+    void compute() {
+        const IterationFrame &f = frame;
+        uint64_t n = 0;
+        for (int y = 0; y < f.height && !task.cancelled(); ++y) {
+            int *row = frame.iters.data() + static_cast<size_t>(y) * f.width;
+            xs.clear(); cols.clear();
+            for (int x = 0; x < f.width; ++x) {
+                if (row[x] >= 0) continue;
+                xs.push_back(pixelToReal(x, f.width, f.view.realMin, f.view.realMax));
+                cols.push_back(x);
+            }
+            if (cols.empty()) continue;
+            out.resize(cols.size());
+            escapeTimeRow(f.fractal, f.tier, xs.data(), static_cast<int>(xs.size()),
+                          pixelToImag(y, f.height, f.view.imagMin, f.view.imagMax), f.params, f.maxIter, out.data());
+            for (size_t i = 0; i < cols.size(); ++i) row[cols[i]] = out[i];
+            n += cols.size();
+        }
+        computed = n;
+        if (!task.cancelled()) done = true;
+    }
+
+    bool targets(int fractal, int maxIter, const ViewBounds &v, const FractalParams &params) const {
+        return frame.compatible(fractal, maxIter, params) && v.realMin == frame.view.realMin &&
+               v.realMax == frame.view.realMax && v.imagMin == frame.view.imagMin && v.imagMax == frame.view.imagMax;
+    }
+    bool pendingFor(int fractal, int maxIter, const ViewBounds &v, const FractalParams &params) const {
+        return !done && task.busy() && targets(fractal, maxIter, v, params);
+    }
+    bool readyFor(int fractal, int maxIter, const ViewBounds &v, const FractalParams &params) {
+        return done && targets(fractal, maxIter, v, params);
+    }
+};
+
+// Color a frame from iteration counts, then antialias it like a fresh render
+void colorizeIterations(sf::Image &image, const IterationFrame &f, RenderStats *stats) {
+    for (int y = 0; y < f.height; ++y) {
+        for (int x = 0; x < f.width; ++x) {
+            image.setPixel(x, y, escapeColor(f.fractal, f.iters[static_cast<size_t>(y) * f.width + x], f.maxIter));
+        }
+    }
+    if (stats) stats->basePixels += f.iters.size();
+    if (f.params.antialias) {
+        antialiasEscapeTime(image, f.iters, f.width, f.height, f.view.realMin, f.view.realMax, f.view.imagMin,
+                            f.view.imagMax, f.maxIter, f.fractal, f.tier, f.params, stats);
+    }
+}
+
+// 64-bit file positioning for outputs larger than 2 GB
+inline int seekFile64(FILE *f, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(f, static_cast<__int64>(offset), SEEK_SET);
+#else
+    return fseeko(f, static_cast<off_t>(offset), SEEK_SET);
+#endif
+}
+
+// Poster rendering: images far larger than memory (32k x 32k RGBA is 4 GB)
+// are rendered in horizontal bands, several bands in parallel, and each band
+// is written straight to its offset in a binary PPM. Peak memory is one band
+// per worker. Completed bands are appended to "<out>.bands" so an interrupted
+// job resumes where it stopped; the file is removed when the poster is done.
+// Only renderers whose pixels depend on complex position alone
+// (CAP_PER_PIXEL) can be split this way. The view is relative to the origin in
+// params.
+bool renderPoster(const std::string &outPath, int fractal, const ViewBounds &view,
+                  int width, int height, int bandRows, int maxIter, const FractalParams &params) {
+    if (width < 2 || height < 2) { std::cerr << "Poster: size must be at least 2x2\n"; return false; }
+    if (bandRows <= 0) bandRows = std::max(2, (4 * 1024 * 1024) / width); // ~16 MB of RGBA per band
+    bandRows = std::max(2, std::min(bandRows, height));
+    const int bands = (height + bandRows - 1) / bandRows;
+
+    // Identify the job so a progress file from a different poster is not reused
+    std::ostringstream jobId;
+    jobId << std::setprecision(17) << "poster " << width << " " << height << " " << bandRows << " " << fractal << " "
+          << maxIter << " " << view.realMin << " " << view.realMax << " " << view.imagMin << " " << view.imagMax
+          << " " << params.originR.hi << " " << params.originR.lo << " " << params.originI.hi << " " << params.originI.lo;
+    const std::string progressPath = outPath + ".bands";
+    std::vector<char> done(bands, 0);
+    int alreadyDone = 0;
+    {
+        std::ifstream prog(progressPath);
+        std::string header;
+        if (prog.is_open() && std::getline(prog, header) && header == jobId.str()) {
+            int b;
+            while (prog >> b) {
+                if (b >= 0 && b < bands && !done[b]) { done[b] = 1; alreadyDone++; }
+            }
+        }
+    }
+
+    std::ostringstream ppmHeader;
+    ppmHeader << "P6\n" << width << " " << height << "\n255\n";
+    const std::string hdr = ppmHeader.str();
+    FILE *out = alreadyDone > 0 ? std::fopen(outPath.c_str(), "r+b") : nullptr;
+    if (!out) {
+        alreadyDone = 0;
+        std::fill(done.begin(), done.end(), 0);
+        out = std::fopen(outPath.c_str(), "wb");
+        if (!out) { std::cerr << "Poster: cannot open " << outPath << "\n"; return false; }
+        std::fwrite(hdr.data(), 1, hdr.size(), out);
+        std::ofstream prog(progressPath, std::ios::trunc);
+        prog << jobId.str() << "\n";
+    } else {
+        std::cout << "Poster: resuming, " << alreadyDone << "/" << bands << " bands already written\n";
+    }
+    std::ofstream progress(progressPath, std::ios::app);
+
+    std::mutex fileMutex;
+    std::atomic<int> nextBand(0);
+    std::atomic<int> bandsDone(alreadyDone);
+    std::atomic<uint64_t> pixelsThisRun(0);
+    std::atomic<bool> failed(false);
+    auto t0 = std::chrono::high_resolution_clock::now();
+    const int workers = std::max(1, std::min(bands, static_cast<int>(std::thread::hardware_concurrency())));
+
+    auto worker = [&]() {
+        sf::Image band;
+        std::vector<uint8_t> rgb(static_cast<size_t>(width) * 3);
+        for (int b = nextBand++; b < bands && !failed; b = nextBand++) {
+            if (done[b]) continue;
+            const int y0 = b * bandRows;
+            const int y1 = std::min(height, y0 + bandRows);
+            // one extra row above and below, as in renderCurrent, so the
+            // antialias variance window sees the same neighbours as in a
+            // full-frame render; only rows [y0, y1) are written
+            const int r0 = std::max(0, y0 - 1), r1 = std::min(height, y1 + 1);
+            const int rows = r1 - r0;
+            band.create(width, rows, sf::Color::Black);
+            renderCurrent(fractal, band, width, rows, view.realMin, view.realMax,
+                          pixelToImag(r1 - 1, height, view.imagMin, view.imagMax),
+                          pixelToImag(r0, height, view.imagMin, view.imagMax), maxIter, nullptr, params,
+                          nullptr, nullptr, 1);
+            const sf::Uint8 *px = band.getPixelsPtr();
+            std::lock_guard<std::mutex> lk(fileMutex);
+            bool ok = seekFile64(out, hdr.size() + static_cast<uint64_t>(y0) * width * 3) == 0;
+            for (int y = y0; y < y1 && ok; ++y) {
+                const sf::Uint8 *row = px + static_cast<size_t>(y - r0) * width * 4;
+                for (int x = 0; x < width; ++x) {
+                    rgb[3 * x] = row[4 * x]; rgb[3 * x + 1] = row[4 * x + 1]; rgb[3 * x + 2] = row[4 * x + 2];
+                }
+                ok = std::fwrite(rgb.data(), 1, rgb.size(), out) == rgb.size();
+            }
+            // record the band only once its pixels reached the file
+            ok = ok && std::fflush(out) == 0;
+            if (!ok) { failed = true; std::cerr << "Poster: write failed at band " << b << "\n"; break; }
+            progress << b << "\n" << std::flush;
+            pixelsThisRun += static_cast<uint64_t>(width) * (y1 - y0);
+            int n = ++bandsDone;
+            double s = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+            std::cout << "Poster band " << n << "/" << bands << " (" << std::fixed << std::setprecision(1)
+                      << (100.0 * n / bands) << "%) " << std::setprecision(2)
+                      << (s > 0.0 ? pixelsThisRun / s / 1e6 : 0.0) << " MP/s\n" << std::defaultfloat;
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 0; i < workers; ++i) pool.emplace_back(worker);
+    for (auto &t : pool) t.join();
+    std::fclose(out);
+    progress.close();
+    if (failed) return false;
+
+    double s = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+    std::cout << "Poster done: " << outPath << " " << width << "x" << height << " in " << s << " s ("
+              << (s > 0.0 ? pixelsThisRun / s / 1e6 : 0.0) << " MP/s, " << workers << " workers, "
+              << bandRows << " rows/band)\n";
+    std::remove(progressPath.c_str());
+    return true;
+}
+
+// Headless Buddhabrot: accumulate `samplesMillions` million samples of `view`
+// (absolute bounds) in rounds, reporting progress, then write a binary PPM
+bool renderBuddhabrotFile(const std::string &outPath, const ViewBounds &view, int width, int height,
+                          double samplesMillions) {
+    if (width < 2 || height < 2) { std::cerr << "Buddhabrot: size must be at least 2x2\n"; return false; }
+    BuddhabrotEngine engine;
+    engine.reset(width, height, view);
+    const uint64_t target = static_cast<uint64_t>(samplesMillions * 1e6);
+    const uint64_t ROUND = 20000000; // progress every 20M samples
+    auto t0 = std::chrono::high_resolution_clock::now();
+    while (engine.samples < target) {
+        engine.accumulate(std::min(ROUND, target - engine.samples), 0.0);
+        double s = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+        std::cout << "Buddhabrot " << std::fixed << std::setprecision(1) << (100.0 * engine.samples / target) << "% "
+                  << (engine.samples / 1e6) << "M samples " << (engine.orbits / 1e6) << "M orbits "
+                  << std::setprecision(2) << (s > 0.0 ? engine.samples / s / 1e6 : 0.0) << " Msamples/s\n"
+                  << std::defaultfloat;
+    }
+    sf::Image image;
+    engine.resolve(image);
+    FILE *out = std::fopen(outPath.c_str(), "wb");
+    if (!out) { std::cerr << "Buddhabrot: cannot open " << outPath << "\n"; return false; }
+    std::fprintf(out, "P6\n%d %d\n255\n", width, height);
+    const sf::Uint8 *px = image.getPixelsPtr();
+    std::vector<uint8_t> rgb(static_cast<size_t>(width) * 3);
+    bool ok = true;
+    for (int y = 0; y < height && ok; ++y) {
+        const sf::Uint8 *row = px + static_cast<size_t>(y) * width * 4;
+        for (int x = 0; x < width; ++x) {
+            rgb[3 * x] = row[4 * x]; rgb[3 * x + 1] = row[4 * x + 1]; rgb[3 * x + 2] = row[4 * x + 2];
+        }
+        ok = std::fwrite(rgb.data(), 1, rgb.size(), out) == rgb.size();
+    }
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok) std::cerr << "Buddhabrot: write failed\n";
+    return ok;
+}
+
+// Raw iteration data ("FIT1") for recoloring and analysis without
+// recomputation. A 128-byte header (fractal, maxIter, tier, resolution, view
+// relative to a double-double origin, Julia c) is followed by planar
+// little-endian arrays of width*height values: int32 iteration counts, float
+// smooth values and, when flagged, float final |z| and float distance
+// estimates. Planes are contiguous so each maps straight onto an array. Files
+// are written and read through MappedFile, so a huge export opens instantly
+// and only the pages a reader touches are loaded.
+enum IterationFields : uint32_t {
+    FIELD_ITERATIONS = 1u << 0,
+    FIELD_SMOOTH = 1u << 1,
+    FIELD_ABS_Z = 1u << 2,
+    FIELD_DISTANCE = 1u << 3,
+};
+
+struct IterationFileHeader {
+    uint32_t magic, version, width, height;
+    int32_t fractal, maxIter, tier;
+    uint32_t fields;
+    double originRHi, originRLo, originIHi, originILo;
+    double realMin, realMax, imagMin, imagMax;
+    double juliaRe, juliaIm;
+    uint8_t reserved[16];
+};
+static_assert(sizeof(IterationFileHeader) == 128, "FIT1 header must stay 128 bytes");
+
+struct IterationFile {
+    static const uint32_t MAGIC = 0x31544946; // "FIT1"
+    static const uint32_t VERSION = 1;
+
+    MappedFile file;
+    IterationFileHeader *header = nullptr;
+    int32_t *iterations = nullptr;
+    float *smooth = nullptr;
+    float *absZ = nullptr;     // null unless FIELD_ABS_Z
+    float *distance = nullptr; // null unless FIELD_DISTANCE
+
+    static size_t planes(uint32_t fields) {
+        size_t n = 0;
+        for (uint32_t f = fields; f; f &= f - 1) ++n;
+        return n;
+    }
+    static size_t bytesFor(uint32_t width, uint32_t height, uint32_t fields) {
+        return sizeof(IterationFileHeader) + planes(fields) * 4 * static_cast<size_t>(width) * height;
+    }
+
+    // New file sized for `h`; the caller fills the planes
+    bool create(const std::string &path, const IterationFileHeader &h) {
+        std::remove(path.c_str()); // a larger old file would keep its tail
+        if (!file.open(path, bytesFor(h.width, h.height, h.fields), true)) return false;
+        header = reinterpret_cast<IterationFileHeader *>(file.data);
+        *header = h;
+        header->magic = MAGIC;
+        header->version = VERSION;
+        bindPlanes();
+        return true;
+    }
+
+    // Existing file, read-only; rejects foreign or truncated files
+    bool open(const std::string &path) {
+        if (!file.open(path, 0, false)) return false;
+        header = reinterpret_cast<IterationFileHeader *>(file.data);
+        const uint32_t required = FIELD_ITERATIONS | FIELD_SMOOTH;
+        if (file.size < sizeof(IterationFileHeader) || header->magic != MAGIC || header->version != VERSION ||
+            (header->fields & required) != required || header->width < 2 || header->height < 2 ||
+            file.size < bytesFor(header->width, header->height, header->fields)) {
+            file.close();
+            header = nullptr;
+            return false;
+        }
+        bindPlanes();
+        return true;
+    }
+
+    void bindPlanes() {
+        const size_t n = static_cast<size_t>(header->width) * header->height;
+        uint8_t *p = file.data + sizeof(IterationFileHeader);
+        iterations = reinterpret_cast<int32_t *>(p); p += 4 * n;
+        smooth = reinterpret_cast<float *>(p); p += 4 * n;
+        absZ = (header->fields & FIELD_ABS_Z) ? reinterpret_cast<float *>(p) : nullptr;
+        if (absZ) p += 4 * n;
+        distance = (header->fields & FIELD_DISTANCE) ? reinterpret_cast<float *>(p) : nullptr;
+    }
+};
+
+// Headless raw export of an escape-time view (relative to the params origin):
+// rows are computed in parallel straight into the mapped file. This is the
+// base pass only; antialiasing is a coloring decision left to the reader.
+bool exportIterationFile(const std::string &outPath, int fractal, const ViewBounds &view, int width, int height,
+                         int maxIter, const FractalParams &params, bool withExtras) {
+    if (width < 2 || height < 2) { std::cerr << "Export: size must be at least 2x2\n"; return false; }
+    IterationFileHeader h;
+    std::memset(&h, 0, sizeof(h));
+    h.width = width; h.height = height;
+    h.fractal = fractal; h.maxIter = maxIter;
+    h.tier = escapePrecisionTier(view.realMin, view.realMax, view.imagMin, view.imagMax, width, height);
+    h.fields = FIELD_ITERATIONS | FIELD_SMOOTH | (withExtras ? (FIELD_ABS_Z | FIELD_DISTANCE) : 0u);
+    h.originRHi = params.originR.hi; h.originRLo = params.originR.lo;
+    h.originIHi = params.originI.hi; h.originILo = params.originI.lo;
+    h.realMin = view.realMin; h.realMax = view.realMax; h.imagMin = view.imagMin; h.imagMax = view.imagMax;
+    h.juliaRe = params.juliaRe; h.juliaIm = params.juliaIm;
+    IterationFile out;
+    if (!out.create(outPath, h)) { std::cerr << "Export: cannot map " << outPath << "\n"; return false; }
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    std::vector<double> xs(width);
+    for (int x = 0; x < width; ++x) xs[x] = pixelToReal(x, width, view.realMin, view.realMax);
+    std::atomic<int> nextRow(0);
+    const int workers = std::max(1, std::min(height, static_cast<int>(std::thread::hardware_concurrency())));
+    auto worker = [&]() {
+        std::vector<EscapeDetail> row(width);
+        for (int y = nextRow++; y < height; y = nextRow++) {
+            escapeDetailRow(fractal, h.tier, xs.data(), width, pixelToImag(y, height, view.imagMin, view.imagMax),
+                            params, maxIter, row.data());
+            const size_t base = static_cast<size_t>(y) * width;
+            for (int x = 0; x < width; ++x) {
+                out.iterations[base + x] = row[x].iterations;
+                out.smooth[base + x] = row[x].smooth;
+                if (out.absZ) out.absZ[base + x] = row[x].absZ;
+                if (out.distance) out.distance[base + x] = row[x].distance;
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 0; i < workers; ++i) pool.emplace_back(worker);
+    for (auto &t : pool) t.join();
+    const size_t bytes = out.file.size;
+    out.file.close();
+
+    double s = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+    std::cout << "Export done: " << outPath << " " << width << "x" << height << " " << precisionTierName(h.tier)
+              << ", " << (bytes >> 20) << " MB in " << s << " s ("
+              << (s > 0.0 ? static_cast<double>(width) * height / s / 1e6 : 0.0) << " MP/s)\n";
+    return true;
+}
+
+// Headless recolor of a FIT1 file into a binary PPM. Palettes: "escape" (the
+// viewer's per-fractal colors from the integer counts), "smooth" (a cyclic
+// gradient over the smooth value) and "distance" (boundary distance in
+// pixels; needs the extra fields).
+bool recolorIterationFile(const std::string &inPath, const std::string &outPath, const std::string &palette) {
+    IterationFile in;
+    if (!in.open(inPath)) { std::cerr << "Recolor: " << inPath << " is not a FIT1 file\n"; return false; }
+    const IterationFileHeader &h = *in.header;
+    if (palette == "distance" && !in.distance) {
+        std::cerr << "Recolor: " << inPath << " has no distance estimates (export with --export-extras)\n";
+        return false;
+    }
+    if (palette != "escape" && palette != "smooth" && palette != "distance") {
+        std::cerr << "Recolor: unknown palette " << palette << "\n";
+        return false;
+    }
+    const int width = static_cast<int>(h.width), height = static_cast<int>(h.height);
+    const double spacing = (h.realMax - h.realMin) / (width - 1);
+    auto t0 = std::chrono::high_resolution_clock::now();
+    FILE *out = std::fopen(outPath.c_str(), "wb");
+    if (!out) { std::cerr << "Recolor: cannot open " << outPath << "\n"; return false; }
+    std::fprintf(out, "P6\n%d %d\n255\n", width, height);
+    std::vector<uint8_t> rgb(static_cast<size_t>(width) * 3);
+    bool ok = true;
+    for (int y = 0; y < height && ok; ++y) {
+        const size_t base = static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; ++x) {
+            sf::Color c = sf::Color::Black;
+            const int it = in.iterations[base + x];
+            if (palette == "escape") {
+                c = escapeColor(h.fractal, it, h.maxIter);
+            } else if (it < h.maxIter && palette == "smooth") {
+                const double t = std::sqrt(std::max(0.0f, in.smooth[base + x])) * 0.35;
+                c = sf::Color(static_cast<sf::Uint8>(127.5 + 127.5 * std::cos(6.2831853 * t)),
+                              static_cast<sf::Uint8>(127.5 + 127.5 * std::cos(6.2831853 * (t + 0.1))),
+                              static_cast<sf::Uint8>(127.5 + 127.5 * std::cos(6.2831853 * (t + 0.2))));
+            } else if (it < h.maxIter) {
+                const float d = in.distance[base + x];
+                const double v = std::isfinite(d) ? std::min(1.0, std::pow(d / (4.0 * spacing), 0.4)) : 1.0;
+                c = sf::Color(static_cast<sf::Uint8>(255 * v), static_cast<sf::Uint8>(255 * v), static_cast<sf::Uint8>(255 * v));
+            }
+            rgb[3 * x] = c.r; rgb[3 * x + 1] = c.g; rgb[3 * x + 2] = c.b;
+        }
+        ok = std::fwrite(rgb.data(), 1, rgb.size(), out) == rgb.size();
+    }
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok) { std::cerr << "Recolor: write failed\n"; return false; }
+    double s = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+    std::cout << "Recolor done: " << outPath << " " << width << "x" << height << " (" << palette << ") in " << s << " s\n";
+    return true;
+}
+
+// Command line options (all optional; the default is the interactive viewer)
+struct AppOptions {
+    std::string streamFormat;   // "" (off), "y4m" or "rgba"
+    std::string streamOut = "-"; // "-" = stdout, otherwise a file or FIFO path
+    int streamFps = 60;
+    int streamQueue = 4;
+    bool zoomVideo = false;      // headless keyframe zoom to zoomTarget, needs --stream
+    ViewBounds zoomTarget;       // only the center and width are given; height follows the window
+    int zoomFrames = 300;
+    std::string posterPath;      // headless band-by-band poster render when set
+    int posterWidth = 0, posterHeight = 0;
+    int bandRows = 0;            // 0 = pick from the poster width
+    int tileCacheMb = 64;        // on-disk tile cache size cap; 0 disables it
+    std::string buddhaPath;      // headless Buddhabrot accumulation when set
+    int buddhaWidth = 0, buddhaHeight = 0;
+    double buddhaSamples = 200.0; // millions of sampled c values
+    std::string exportPath;      // headless raw iteration export (FIT1) when set
+    int exportWidth = 0, exportHeight = 0;
+    bool exportExtras = false;   // also store final |z| and distance estimates
+    std::string recolorIn, recolorOut; // headless FIT1 -> PPM
+    std::string palette = "smooth";
+    std::string recordPath;     // record the interactive session's input when set
+    std::string replayPath;     // replay a recording headlessly and report when set
+    bool replayFast = false;    // replay without waiting for 60 Hz frame ticks
+    int historyMb = 64;         // memory for cached frames of the view history; 0 disables it
+    bool antialias = false;     // start with adaptive antialiasing on (also for headless output)
+};
+
+void printUsage() {
+    std::cerr << "Usage: FractalApp [options]\n"
+              << "  --stream y4m|rgba     stream every displayed frame as Y4M or raw RGBA\n"
+              << "  --stream-out <path>   stream destination, '-' for stdout (default)\n"
+              << "  --stream-fps <n>      frame rate written to the Y4M header (default 60)\n"
+              << "  --stream-queue <n>    frames rendering may run ahead of the writer (default 4)\n"
+              << "  --zoom-video <re> <im> <width>  render a zoom from the saved view to this view\n"
+              << "                        headlessly into the stream and exit\n"
+              << "  --frames <n>          frame count for --zoom-video (default 300)\n"
+              << "  --poster <w> <h> <out.ppm>  render the saved view as a large PPM in bands and exit;\n"
+              << "                        rerun the same command to resume an interrupted poster\n"
+              << "  --band-rows <n>       rows per poster band (default: about 16 MB per band)\n"
+              << "  --tile-cache-mb <n>   size cap of the on-disk tile cache, 0 disables it (default 64)\n"
+              << "  --buddhabrot <w> <h> <out.ppm>  accumulate a Buddhabrot of the saved view and exit\n"
+              << "  --samples <millions>  sampled c values for --buddhabrot (default 200)\n"
+              << "  --export-iter <w> <h> <out.fit>  write raw iteration data of the saved view and exit\n"
+              << "  --export-extras       also store final |z| and distance estimates in --export-iter\n"
+              << "  --recolor <in.fit> <out.ppm>  color an exported file without recomputing and exit\n"
+              << "  --palette escape|smooth|distance  colors for --recolor (default smooth)\n"
+              << "  --record <file>       record this session's input for --replay\n"
+              << "  --replay <file>       replay a recording headlessly on a virtual clock, append\n"
+              << "                        frame times, precache hits and render work to replay_results.csv\n"
+              << "  --replay-fast         replay without pacing frames to 60 Hz\n"
+              << "  --history-mb <n>      memory for cached frames of the view history (default 64)\n"
+              << "  --antialias           antialias escape-time frames, posters and zoom videos\n";
+}
+
+bool parseOptions(int argc, char **argv, AppOptions &opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (a == "--stream" && hasValue) opt.streamFormat = argv[++i];
+            else if (a == "--stream-out" && hasValue) opt.streamOut = argv[++i];
+            else if (a == "--stream-fps" && hasValue) opt.streamFps = std::stoi(argv[++i]);
+            else if (a == "--stream-queue" && hasValue) opt.streamQueue = std::stoi(argv[++i]);
+            else if (a == "--zoom-video" && i + 3 < argc) {
+                double re = std::stod(argv[i + 1]), im = std::stod(argv[i + 2]), w = std::stod(argv[i + 3]);
+                i += 3;
+                opt.zoomVideo = true;
+                opt.zoomTarget = ViewBounds(re - w / 2.0, re + w / 2.0, im, im);
+            }
+            else if (a == "--frames" && hasValue) opt.zoomFrames = std::max(1, std::stoi(argv[++i]));
+            else if (a == "--poster" && i + 3 < argc) {
+                opt.posterWidth = std::stoi(argv[i + 1]);
+                opt.posterHeight = std::stoi(argv[i + 2]);
+                opt.posterPath = argv[i + 3];
+                i += 3;
+            }
+            else if (a == "--band-rows" && hasValue) opt.bandRows = std::stoi(argv[++i]);
+            else if (a == "--tile-cache-mb" && hasValue) opt.tileCacheMb = std::max(0, std::stoi(argv[++i]));
+            else if (a == "--buddhabrot" && i + 3 < argc) {
+                opt.buddhaWidth = std::stoi(argv[i + 1]);
+                opt.buddhaHeight = std::stoi(argv[i + 2]);
+                opt.buddhaPath = argv[i + 3];
+                i += 3;
+            }
+            else if (a == "--samples" && hasValue) opt.buddhaSamples = std::max(0.001, std::stod(argv[++i]));
+            else if (a == "--export-iter" && i + 3 < argc) {
+                opt.exportWidth = std::stoi(argv[i + 1]);
+                opt.exportHeight = std::stoi(argv[i + 2]);
+                opt.exportPath = argv[i + 3];
+                i += 3;
+            }
+            else if (a == "--export-extras") opt.exportExtras = true;
+            else if (a == "--recolor" && i + 2 < argc) {
+                opt.recolorIn = argv[i + 1];
+                opt.recolorOut = argv[i + 2];
+                i += 2;
+            }
+            else if (a == "--palette" && hasValue) opt.palette = argv[++i];
+            else if (a == "--record" && hasValue) opt.recordPath = argv[++i];
+            else if (a == "--replay" && hasValue) opt.replayPath = argv[++i];
+            else if (a == "--replay-fast") opt.replayFast = true;
+            else if (a == "--antialias") opt.antialias = true;
+            else if (a == "--history-mb" && hasValue) opt.historyMb = std::max(0, std::stoi(argv[++i]));
+            else { printUsage(); return false; }
+        } catch (...) {
+            std::cerr << "Invalid value for " << a << "\n";
+            return false;
+        }
+    }
+    if (!opt.streamFormat.empty() && opt.streamFormat != "y4m" && opt.streamFormat != "rgba") {
+        std::cerr << "Unknown stream format: " << opt.streamFormat << "\n";
+        return false;
+    }
+    if (opt.zoomVideo && opt.streamFormat.empty()) {
+        std::cerr << "--zoom-video needs --stream\n";
+        return false;
+    }
+    if (!opt.recordPath.empty() && !opt.replayPath.empty()) {
+        std::cerr << "--record and --replay cannot be combined\n";
+        return false;
+    }
+    return true;
+}
+
+// Create a CSV with `header` if missing. A file whose header differs (older
+// columns) is renamed to "<path>.old" first so rows never mix layouts.
+void ensureCsvHeader(const std::string &path, const std::string &header) {
+    try {
+        bool present = false;
+        {
+            std::ifstream in(path);
+            std::string existing;
+            present = in.good();
+            if (present && std::getline(in, existing) && existing == header) return;
+        }
+        if (present) {
+            std::remove((path + ".old").c_str());
+            std::rename(path.c_str(), (path + ".old").c_str());
+        }
+        std::ofstream out(path, std::ios::trunc);
+        if (out.is_open()) out << header << "\n";
+    } catch (...) {}
+}
+
+// Interactive input recording (--record) and deterministic replay
+// (--replay). A recording is a text file, one item per line:
+//   FRP1 <width> <height>
+//   start <fractal> <originR hi lo> <originI hi lo> <realMin realMax imagMin imagMax> <antialias> <juliaRe juliaIm>
+//   <t> wheel <delta> <x> <y>  |  <t> click <x> <y>  |  <t> move <x> <y>
+//   <t> key <code> <shift> [<control>]  |  <t> hold <zoomIn> <zoomOut>  |  <t> end
+// t is the loop clock in seconds since recording started; hold lines are
+// written when the held zoom keys change. A replay starts from the recorded
+// state instead of the saved settings. It runs the main loop on a virtual
+// clock that advances exactly one 60 Hz frame per iteration and feeds each
+// event to the same handlers on the first frame whose time reaches it. The
+// view path is therefore the same on every run and build; only timings, and
+// which background frames arrive in time, vary.
+struct InputRecord {
+    enum Kind { WHEEL, CLICK, MOVE, KEY, HOLD };
+    double t = 0.0;
+    Kind kind = WHEEL;
+    float delta = 0.0f;
+    int x = 0, y = 0; // pixel; key code and shift; held zoom-in and zoom-out
+    int control = 0;  // key: Control held
+};
+
+struct InputScript {
+    int width = 0, height = 0, fractal = MADELBROT;
+    DD originR, originI;
+    ViewBounds view;
+    bool antialias = false;
+    double juliaRe = 0.0, juliaIm = 0.0;
+    std::vector<InputRecord> records;
+    double endTime = 0.0;
+    // replay position and the zoom keys held at it
+    size_t next = 0;
+    bool zoomIn = false, zoomOut = false;
+
+    bool load(const std::string &path) {
+        std::ifstream in(path);
+        if (!in.is_open()) { std::cerr << "Replay: cannot open " << path << "\n"; return false; }
+        std::string magic, tag;
+        int aa = 0;
+        if (!(in >> magic >> width >> height) || magic != "FRP1" ||
+            !(in >> tag >> fractal >> originR.hi >> originR.lo >> originI.hi >> originI.lo >> view.realMin >>
+              view.realMax >> view.imagMin >> view.imagMax >> aa >> juliaRe >> juliaIm) ||
+            tag != "start" || !isRegisteredFractal(fractal)) {
+            std::cerr << "Replay: " << path << " is not an input recording\n";
+            return false;
+        }
+        antialias = aa != 0;
+        std::string line;
+        std::getline(in, line); // rest of the start line
+        while (std::getline(in, line)) {
+            std::istringstream ls(line);
+            InputRecord r;
+            std::string kind;
+            if (!(ls >> r.t >> kind)) continue;
+            bool ok;
+            if (kind == "wheel") { r.kind = InputRecord::WHEEL; ok = static_cast<bool>(ls >> r.delta >> r.x >> r.y); }
+            else if (kind == "click") { r.kind = InputRecord::CLICK; ok = static_cast<bool>(ls >> r.x >> r.y); }
+            else if (kind == "move") { r.kind = InputRecord::MOVE; ok = static_cast<bool>(ls >> r.x >> r.y); }
+            else if (kind == "key") {
+                r.kind = InputRecord::KEY;
+                ok = static_cast<bool>(ls >> r.x >> r.y);
+                if (!(ls >> r.control)) r.control = 0;
+            }
+            else if (kind == "hold") { r.kind = InputRecord::HOLD; ok = static_cast<bool>(ls >> r.x >> r.y); }
+            else if (kind == "end") { endTime = r.t; continue; }
+            else ok = false;
+            if (!ok) { std::cerr << "Replay: bad line in " << path << ": " << line << "\n"; return false; }
+            records.push_back(r);
+        }
+        if (!records.empty()) endTime = std::max(endTime, records.back().t);
+        return true;
+    }
+
+    // The next recorded event due at time `now`, as the sf::Event the window
+    // would have delivered. Hold records only update zoomIn/zoomOut.
+    bool poll(double now, sf::Event &event) {
+        while (next < records.size() && records[next].t <= now) {
+            const InputRecord &r = records[next++];
+            switch (r.kind) {
+            case InputRecord::WHEEL:
+                event.type = sf::Event::MouseWheelScrolled;
+                event.mouseWheelScroll.wheel = sf::Mouse::VerticalWheel;
+                event.mouseWheelScroll.delta = r.delta;
+                event.mouseWheelScroll.x = r.x;
+                event.mouseWheelScroll.y = r.y;
+                return true;
+            case InputRecord::CLICK:
+                event.type = sf::Event::MouseButtonPressed;
+                event.mouseButton.button = sf::Mouse::Left;
+                event.mouseButton.x = r.x;
+                event.mouseButton.y = r.y;
+                return true;
+            case InputRecord::MOVE:
+                event.type = sf::Event::MouseMoved;
+                event.mouseMove.x = r.x;
+                event.mouseMove.y = r.y;
+                return true;
+            case InputRecord::KEY:
+                event.type = sf::Event::KeyPressed;
+                event.key.code = static_cast<sf::Keyboard::Key>(r.x);
+                event.key.shift = r.y != 0;
+                event.key.control = r.control != 0;
+                event.key.alt = event.key.system = false;
+                return true;
+            case InputRecord::HOLD:
+                zoomIn = r.x != 0;
+                zoomOut = r.y != 0;
+                break;
+            }
+        }
+        return false;
+    }
+    bool finished(double now) const { return next >= records.size() && now >= endTime; }
+};
+
+struct InputRecorder {
+    std::ofstream out;
+    bool zoomIn = false, zoomOut = false;
+
+    bool open(const std::string &path, int width, int height, int fractal, const FractalParams &p, const ViewBounds &view) {
+        out.open(path, std::ios::trunc);
+        if (!out.is_open()) { std::cerr << "Record: cannot open " << path << "\n"; return false; }
+        out << std::setprecision(17) << "FRP1 " << width << " " << height << "\n"
+            << "start " << fractal << " " << p.originR.hi << " " << p.originR.lo << " " << p.originI.hi << " "
+            << p.originI.lo << " " << view.realMin << " " << view.realMax << " " << view.imagMin << " " << view.imagMax
+            << " " << (p.antialias ? 1 : 0) << " " << p.juliaRe << " " << p.juliaIm << "\n";
+        return true;
+    }
+    bool isOpen() const { return out.is_open(); }
+    // the events the main loop handles; mouse moves only matter in Julia mode
+    void event(double t, const sf::Event &e, bool juliaMode) {
+        if (e.type == sf::Event::MouseWheelScrolled && e.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel) {
+            out << t << " wheel " << e.mouseWheelScroll.delta << " " << e.mouseWheelScroll.x << " " << e.mouseWheelScroll.y << "\n";
+        } else if (e.type == sf::Event::MouseButtonPressed && e.mouseButton.button == sf::Mouse::Left) {
+            out << t << " click " << e.mouseButton.x << " " << e.mouseButton.y << "\n";
+        } else if (e.type == sf::Event::MouseMoved && juliaMode) {
+            out << t << " move " << e.mouseMove.x << " " << e.mouseMove.y << "\n";
+        } else if (e.type == sf::Event::KeyPressed) {
+            out << t << " key " << static_cast<int>(e.key.code) << " " << (e.key.shift ? 1 : 0) << " "
+                << (e.key.control ? 1 : 0) << "\n";
+        }
+    }
+    void hold(double t, bool in, bool outKey) {
+        if (in == zoomIn && outKey == zoomOut) return;
+        zoomIn = in; zoomOut = outKey;
+        out << t << " hold " << (in ? 1 : 0) << " " << (outKey ? 1 : 0) << "\n";
+    }
+    void end(double t) {
+        out << t << " end\n";
+        out.close();
+    }
+};
+
+// What one replay cost. Work is the loop time of a frame without the wait
+// for the next 60 Hz tick. Precache hits and misses count animation frames
+// that had precached frames requested, by whether theirs was ready.
+struct ReplayStats {
+    LatencyHistogram work;
+    double workMaxMs = 0.0, renderMs = 0.0;
+    uint64_t frames = 0, overBudget = 0, animFrames = 0;
+    uint64_t precacheHits = 0, precacheMisses = 0, previews = 0, renders = 0;
+    uint64_t completions = 0, completionSamples = 0;
+    int tileCacheMb = 0;              // size of the (initially empty) tile cache; 0 = off
+    uint64_t tileHits = 0, tileMisses = 0;
+
+    void addFrame(double ms) {
+        work.record(ms);
+        workMaxMs = std::max(workMaxMs, ms);
+        ++frames;
+        if (ms > 1000.0 / 60.0) ++overBudget;
+    }
+
+    // print the results and append them as one row to `path`
+    void report(const std::string &path, const std::string &script, double virtualS, double wallS,
+                const RenderStats &rs, const DD &centerR, const DD &centerI, double width) const {
+        const uint64_t lookups = precacheHits + precacheMisses;
+        const double hitRate = lookups ? static_cast<double>(precacheHits) / lookups : 0.0;
+        std::cout << std::setprecision(6) << "Replay " << script << ": " << frames << " frames (" << virtualS
+                  << " s virtual, " << wallS << " s wall)\n"
+                  << "  work ms p50=" << work.percentileMs(0.50) << " p95=" << work.percentileMs(0.95)
+                  << " p99=" << work.percentileMs(0.99) << " p99.9=" << work.percentileMs(0.999) << " max=" << workMaxMs
+                  << " over 16.7 ms=" << overBudget << "\n"
+                  << "  animation frames=" << animFrames << " precache hits=" << precacheHits << " misses="
+                  << precacheMisses << " (" << 100.0 * hitRate << "%) previews=" << previews << "\n"
+                  << "  renders=" << renders << " render ms=" << renderMs << " base pixels=" << rs.basePixels
+                  << " aa samples=" << rs.aaSamples << " completions=" << completions << " (" << completionSamples
+                  << " samples)\n"
+                  << "  tile cache=" << (tileCacheMb ? std::to_string(tileCacheMb) + " MB, empty at start" : std::string("off"))
+                  << " hits=" << tileHits << " misses=" << tileMisses << "\n"
+                  << std::setprecision(17) << "  final view center=(" << centerR.toDouble() << ", "
+                  << centerI.toDouble() << ") width=" << width << "\n";
+        ensureCsvHeader(path, "ts,build,script,frames,virtual_s,wall_s,work_p50,work_p95,work_p99,work_p999,work_max,"
+                              "over_budget,anim_frames,precache_hits,precache_misses,precache_hit_rate,previews,"
+                              "renders,render_ms,base_pixels,aa_samples,completions,completion_samples,"
+                              "tile_cache_mb,tile_hits,tile_misses,"
+                              "center_re_hi,center_re_lo,center_im_hi,center_im_lo,width");
+        std::ofstream out(path, std::ios::app);
+        if (!out.is_open()) return;
+        out << std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()) << "," << __DATE__ " " __TIME__
+            << "," << script << "," << frames << "," << virtualS << "," << wallS << "," << work.percentileMs(0.50) << ","
+            << work.percentileMs(0.95) << "," << work.percentileMs(0.99) << "," << work.percentileMs(0.999) << ","
+            << workMaxMs << "," << overBudget << "," << animFrames << "," << precacheHits << "," << precacheMisses << ","
+            << hitRate << "," << previews << "," << renders << "," << renderMs << "," << rs.basePixels << ","
+            << rs.aaSamples << "," << completions << "," << completionSamples << "," << tileCacheMb << ","
+            << tileHits << "," << tileMisses << "," << std::setprecision(17)
+            << centerR.hi << "," << centerR.lo << "," << centerI.hi << "," << centerI.lo << "," << width << "\n";
+    }
+};
+
+// Replace `path` with `text` atomically: write a sibling temp file, flush it
+// to disk and rename it over the target (MoveFileEx on Windows, where
+// rename() does not replace an existing file). Readers see the old or the
+// new file, never a truncated one.
+bool writeFileAtomic(const std::string &path, const std::string &text) {
+    const std::string tmp = path + ".tmp";
+    FILE *f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(text.data(), 1, text.size(), f) == text.size();
+    ok = std::fflush(f) == 0 && ok;
+#ifdef _WIN32
+    ok = _commit(_fileno(f)) == 0 && ok;
+#else
+    ok = fsync(fileno(f)) == 0 && ok;
+#endif
+    ok = std::fclose(f) == 0 && ok;
+    if (ok) {
+#ifdef _WIN32
+        ok = MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        ok = std::rename(tmp.c_str(), path.c_str()) == 0;
+#endif
+    }
+    if (!ok) std::remove(tmp.c_str());
+    return ok;
 }
 
-// Dragon curve using L-system
-std::string dragonLSystem(int depth) {
-    std::string s = "FX";
-    for (int i = 0; i < depth; ++i) {
-        std::string next;
-        for (char c : s) {
-            if (c == 'X') next += "X+YF+";
-            else if (c == 'Y') next += "-FX-Y";
-            else next.push_back(c);
+// Background writer for small state files (settings, view history), so the
+// UI thread never waits on the disk. write() returns at once; only the
+// latest text per path is kept, and each file is replaced with
+// writeFileAtomic(). The destructor writes whatever is still pending.
+class AsyncFileWriter {
+public:
+    AsyncFileWriter() : worker([this] { loop(); }) {}
+    AsyncFileWriter(const AsyncFileWriter &) = delete;
+    AsyncFileWriter &operator=(const AsyncFileWriter &) = delete;
+    ~AsyncFileWriter() {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            stopping = true;
         }
-        s.swap(next);
+        cv.notify_one();
+        worker.join();
     }
-    return s;
-}
 
-void renderDragon(sf::Image &image, int width, int height,
-                  double realMin, double realMax,
-                  double imagMin, double imagMax) {
-    image.create(width, height, sf::Color::Black);
-    int depth = 12;
-    std::string prog = dragonLSystem(depth);
-    double angle = 0.0;
-    // Use a fixed reference world width so the dragon's geometry doesn't
-    // cancel out when mapped to pixels. This makes the curve scale/translate
-    // correctly as the view (realMin/realMax) changes.
-    constexpr double REF_WORLD_WIDTH = 3.5; // initial world width (INIT_REAL_MAX - INIT_REAL_MIN)
-    double step = (REF_WORLD_WIDTH) / static_cast<double>(width) * 2.0; // ~2 pixels per segment at reference scale
-    double cx = (realMin + realMax) / 2.0;
-    double cy = (imagMin + imagMax) / 2.0;
-    double x = cx - (REF_WORLD_WIDTH) / 4.0;
-    double y = cy;
+    void write(const std::string &path, std::string text) {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            pending[path] = std::move(text);
+        }
+        cv.notify_one();
+    }
 
-    // First build the list of complex points for the curve, then map to pixels
-    std::vector<std::pair<double,double>> points;
-    points.reserve(prog.size());
-    for (char c : prog) {
-        if (c == 'F') {
-            double nx = x + cos(angle) * step;
-            double ny = y + sin(angle) * step;
-            points.emplace_back(x, y);
-            // advance
-            x = nx; y = ny;
-        } else if (c == '+') {
-            angle += PI / 2.0;
-        } else if (c == '-') {
-            angle -= PI / 2.0;
+    std::atomic<uint64_t> written{0}, failed{0};
+
+private:
+    void loop() {
+        std::unique_lock<std::mutex> lk(m);
+        while (true) {
+            cv.wait(lk, [&] { return stopping || !pending.empty(); });
+            while (!pending.empty()) {
+                auto it = pending.begin();
+                const std::string path = it->first;
+                const std::string text = std::move(it->second);
+                pending.erase(it);
+                lk.unlock();
+                if (writeFileAtomic(path, text)) {
+                    ++written;
+                } else {
+                    ++failed;
+                    std::cerr << "Could not write " << path << "\n";
+                }
+                lk.lock();
+            }
+            if (stopping) return;
         }
     }
 
-    int minX = width, minY = height, maxX = 0, maxY = 0;
-    // map points to pixels and draw lines between successive mapped points
-    for (size_t i = 1; i < points.size(); ++i) {
-        int x0 = realToPixel(points[i-1].first, width, realMin, realMax);
-        int y0 = imagToPixel(points[i-1].second, height, imagMin, imagMax);
-        int x1 = realToPixel(points[i].first, width, realMin, realMax);
-        int y1 = imagToPixel(points[i].second, height, imagMin, imagMax);
-        // color shades of red reminiscent of the China flag
-        double t = static_cast<double>(i) / std::max<size_t>(1, points.size()-1);
-        uint8_t r = static_cast<uint8_t>(std::min(255.0, 120.0 + 135.0 * t));
-        sf::Color col(r, 20, 20);
-        drawLine(image, x0, y0, x1, y1, col);
-        minX = std::min({minX, x0, x1}); maxX = std::max({maxX, x0, x1});
-        minY = std::min({minY, y0, y1}); maxY = std::max({maxY, y0, y1});
+    std::mutex m;
+    std::condition_variable cv;
+    std::map<std::string, std::string> pending;
+    bool stopping = false;
+    std::thread worker; // last: started once the members above exist
+};
+
+// Everything that determines the viewer's frame; the view is relative to
+// the origin, as in the main loop
+struct ViewState {
+    int fractal = MADELBROT;
+    DD originR, originI;
+    ViewBounds view;
+    bool antialias = false;
+    double juliaRe = 0.0, juliaIm = 0.0;
+
+    ViewState() {}
+    ViewState(int f, const ViewBounds &v, const FractalParams &p)
+        : fractal(f), originR(p.originR), originI(p.originI), view(v), antialias(p.antialias),
+          juliaRe(p.juliaRe), juliaIm(p.juliaIm) {}
+    void applyTo(FractalParams &p) const {
+        p.originR = originR; p.originI = originI;
+        p.antialias = antialias;
+        p.juliaRe = juliaRe; p.juliaIm = juliaIm;
     }
+    bool operator==(const ViewState &o) const {
+        return fractal == o.fractal && originR.hi == o.originR.hi && originR.lo == o.originR.lo &&
+               originI.hi == o.originI.hi && originI.lo == o.originI.lo && view.realMin == o.view.realMin &&
+               view.realMax == o.view.realMax && view.imagMin == o.view.imagMin && view.imagMax == o.view.imagMax &&
+               antialias == o.antialias && juliaRe == o.juliaRe && juliaIm == o.juliaIm;
+    }
+    bool operator!=(const ViewState &o) const { return !(*this == o); }
+};
 
-    // Log diagnostic info: step and a few sample mapped pixels to see whether mapping varies
-    std::cout << "Dragon step=" << step << " samples=";
-    for (size_t i = 0; i < points.size() && i < 5; ++i) {
-        int sx = realToPixel(points[i].first, width, realMin, realMax);
-        int sy = imagToPixel(points[i].second, height, imagMin, imagMax);
-        std::cout << "(" << sx << "," << sy << ")";
-        if (i + 1 < points.size() && i + 1 < 5) std::cout << ",";
+// Navigation history of settled views, browser style: stepping back and
+// then moving to a new view drops the forward entries. Persisted as text
+// next to the settings file:
+//   cursor=<index>
+//   view=<fractal> <originR hi lo> <originI hi lo> <realMin realMax imagMin imagMax> <antialias> <juliaRe juliaIm>
+struct ViewHistory {
+    static const size_t MAX_ENTRIES = 100;
+    std::vector<ViewState> entries;
+    size_t cursor = 0; // entries[cursor] is the current view when not empty
+
+    const ViewState *current() const { return entries.empty() ? nullptr : &entries[cursor]; }
+
+    // make `s` the current entry; false when it already was
+    bool push(const ViewState &s) {
+        if (!entries.empty() && entries[cursor] == s) return false;
+        if (!entries.empty()) entries.resize(cursor + 1);
+        entries.push_back(s);
+        if (entries.size() > MAX_ENTRIES) entries.erase(entries.begin());
+        cursor = entries.size() - 1;
+        return true;
+    }
+    // Step from `now` to the previous / next entry. `now` is recorded first
+    // when it is not the current entry, so the other direction returns to it.
+    bool back(const ViewState &now, ViewState &out) {
+        push(now);
+        if (cursor == 0) return false;
+        out = entries[--cursor];
+        return true;
+    }
+    bool forward(const ViewState &now, ViewState &out) {
+        push(now);
+        if (cursor + 1 >= entries.size()) return false;
+        out = entries[++cursor];
+        return true;
     }
-    std::cout << "\n";
 
-    std::cout << "Dragon drawn bounds px=["<<minX<<","<<maxX<<"] py=["<<minY<<","<<maxY<<"]\n";
-}
+    std::string serialize() const {
+        std::ostringstream out;
+        out << std::setprecision(17) << "cursor=" << cursor << "\n";
+        for (const ViewState &s : entries) {
+            out << "view=" << s.fractal << " " << s.originR.hi << " " << s.originR.lo << " " << s.originI.hi << " "
+                << s.originI.lo << " " << s.view.realMin << " " << s.view.realMax << " " << s.view.imagMin << " "
+                << s.view.imagMax << " " << (s.antialias ? 1 : 0) << " " << s.juliaRe << " " << s.juliaIm << "\n";
+        }
+        return out.str();
+    }
+    // unreadable lines are skipped; a missing file is an empty history
+    void load(const std::string &path) {
+        std::ifstream in(path);
+        std::string line;
+        size_t savedCursor = 0;
+        while (std::getline(in, line)) {
+            std::istringstream ls(line.substr(line.find('=') + 1));
+            if (line.compare(0, 7, "cursor=") == 0) {
+                ls >> savedCursor;
+            } else if (line.compare(0, 5, "view=") == 0) {
+                ViewState s;
+                int aa = 0;
+                if (ls >> s.fractal >> s.originR.hi >> s.originR.lo >> s.originI.hi >> s.originI.lo >> s.view.realMin >>
+                        s.view.realMax >> s.view.imagMin >> s.view.imagMax >> aa >> s.juliaRe >> s.juliaIm &&
+                    isRegisteredFractal(s.fractal)) {
+                    s.antialias = aa != 0;
+                    entries.push_back(s);
+                }
+            }
+        }
+        if (entries.size() > MAX_ENTRIES) entries.erase(entries.begin(), entries.end() - MAX_ENTRIES);
+        cursor = entries.empty() ? 0 : std::min(savedCursor, entries.size() - 1);
+    }
+};
 
-// Master dispatcher
-enum FractalType { MADELBROT = 1, SIERPINSKI = 2, KOCH = 3, MENGER = 4, DRAGON = 5 };
+// Recently completed frames keyed by view state, kept within a memory
+// budget (least recently used dropped first), so returning to a view is a
+// texture swap. Escape-time frames also keep their iteration counts,
+// run-length encoded, so a restored view is again a zoom-preview source.
+struct FrameHistoryCache {
+    struct Entry {
+        ViewState state;
+        sf::Image image;
+        IterationFrame frame;    // metadata only; iters live in `runs`
+        std::vector<int> runs;   // (value, count) pairs
+        size_t bytes = 0;
+    };
+    size_t budget, bytes = 0;
+    std::vector<std::unique_ptr<Entry>> entries; // least recently used first
+    uint64_t hits = 0, misses = 0;
 
-void renderCurrent(int fractal, sf::Image &image, int width, int height,
-                   double realMin, double realMax, double imagMin, double imagMax, int maxIter) {
-    std::cout << "renderCurrent called: fractal=" << fractal
-              << " bounds=[" << realMin << "," << realMax << "," << imagMin << "," << imagMax << "]\n";
-    switch (fractal) {
-        case MADELBROT: renderMandelbrot(image, width, height, realMin, realMax, imagMin, imagMax, maxIter); break;
-        case SIERPINSKI: renderSierpinski(image, width, height, realMin, realMax, imagMin, imagMax); break;
-        case KOCH: renderKoch(image, width, height, realMin, realMax, imagMin, imagMax); break;
-        case MENGER: renderMenger(image, width, height, realMin, realMax, imagMin, imagMax); break;
-        case DRAGON: renderDragon(image, width, height, realMin, realMax, imagMin, imagMax); break;
-        default: renderMandelbrot(image, width, height, realMin, realMax, imagMin, imagMax, maxIter); break;
+    explicit FrameHistoryCache(size_t budgetBytes) : budget(budgetBytes) {}
+
+    // `frame` (may be null) must hold the iteration counts of this image
+    void store(const ViewState &s, const sf::Image &image, const IterationFrame *frame) {
+        drop(s);
+        std::unique_ptr<Entry> e(new Entry());
+        e->state = s;
+        e->image = image;
+        if (frame && frame->valid()) {
+            e->frame.describe(frame->fractal, frame->maxIter, frame->width, frame->height, frame->view, frame->params);
+            const std::vector<int> &it = frame->iters;
+            for (size_t i = 0; i < it.size();) {
+                size_t j = i + 1;
+                while (j < it.size() && it[j] == it[i] && j - i < static_cast<size_t>(INT_MAX)) ++j;
+                e->runs.push_back(it[i]);
+                e->runs.push_back(static_cast<int>(j - i));
+                i = j;
+            }
+        }
+        e->bytes = static_cast<size_t>(image.getSize().x) * image.getSize().y * 4 + e->runs.size() * sizeof(int);
+        if (e->bytes > budget) return;
+        bytes += e->bytes;
+        entries.push_back(std::move(e));
+        while (bytes > budget) {
+            bytes -= entries.front()->bytes;
+            entries.erase(entries.begin());
+        }
     }
-}
+
+    // Copy the cached frame of `s` into `image` (and its iterations into
+    // `frame` when it has them); false when `s` is not cached
+    bool restore(const ViewState &s, sf::Image &image, IterationFrame &frame) {
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i]->state != s) continue;
+            std::unique_ptr<Entry> e = std::move(entries[i]);
+            entries.erase(entries.begin() + i);
+            image = e->image;
+            if (!e->runs.empty()) {
+                frame.describe(e->frame.fractal, e->frame.maxIter, e->frame.width, e->frame.height, e->frame.view,
+                               e->frame.params);
+                frame.iters.clear();
+                for (size_t r = 0; r < e->runs.size(); r += 2) frame.iters.insert(frame.iters.end(), e->runs[r + 1], e->runs[r]);
+            }
+            entries.push_back(std::move(e));
+            ++hits;
+            return true;
+        }
+        ++misses;
+        return false;
+    }
+
+    void drop(const ViewState &s) {
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i]->state != s) continue;
+            bytes -= entries[i]->bytes;
+            entries.erase(entries.begin() + i);
+            return;
+        }
+    }
+};
 
 // Forward declarations for settings helpers (defined later in this file)
-bool loadSettings(const std::string &path, double &centerReal, double &centerImag, double &width, int &fractal);
-bool saveSettings(const std::string &path, double centerReal, double centerImag, double width, int fractal);
+bool loadSettings(const std::string &path, DD &centerReal, DD &centerImag, double &width, double &height, int &fractal);
+bool saveSettings(const std::string &path, const DD &centerReal, const DD &centerImag, double width, double height, int fractal);
+std::string settingsText(const DD &centerReal, const DD &centerImag, double width, double height, int fractal);
 
-int main() {
+int main(int argc, char **argv) {
     const int WIDTH = 640;
     const int HEIGHT = 480;
     const int MAX_ITER = 50; // lowered from 100 to improve frame times
-    
-    // Create window
-    sf::RenderWindow window(sf::VideoMode(WIDTH, HEIGHT), "Mandelbrot Fractal");
-    window.setFramerateLimit(60);
+
+    AppOptions options;
+    if (!parseOptions(argc, argv, options)) return 1;
+
+    // Headless recolor needs nothing but the exported file
+    if (!options.recolorIn.empty()) {
+        return recolorIterationFile(options.recolorIn, options.recolorOut, options.palette) ? 0 : 1;
+    }
+
+    // Optional raw video output. When streaming to stdout, route diagnostics to
+    // stderr so they cannot corrupt the video stream.
+    FrameStream frameStream;
+    std::streambuf *coutBuf = std::cout.rdbuf();
+    if (!options.streamFormat.empty()) {
+        if (options.streamOut == "-") std::cout.rdbuf(std::cerr.rdbuf());
+        FrameStream::Format fmt = options.streamFormat == "rgba" ? FrameStream::RAW_RGBA : FrameStream::Y4M;
+        if (!frameStream.open(options.streamOut, fmt, WIDTH, HEIGHT, options.streamFps, options.streamQueue)) {
+            std::cout.rdbuf(coutBuf);
+            return 1;
+        }
+    }
     
     // Create image to draw fractal
     sf::Image image;
@@ -388,21 +3546,28 @@ int main() {
 
     double realMin, realMax, imagMin, imagMax;
     int currentFractal = MADELBROT;
+    FractalParams fractalParams; // Julia c follows the mouse in Julia mode
+    fractalParams.antialias = options.antialias;
 
-    // Try to load persisted center & width & fractal; if present, derive bounds preserving aspect ratio
-    double savedCenterReal = 0.0, savedCenterImag = 0.0, savedWidth = 0.0;
+    // Try to load persisted center & size & fractal. The center becomes the
+    // double-double origin and the bounds are kept relative to it.
+    DD savedCenterReal, savedCenterImag;
+    double savedWidth = 0.0, savedHeight = 0.0;
     int savedFractal = MADELBROT;
-    bool haveSaved = loadSettings(settingsPath, savedCenterReal, savedCenterImag, savedWidth, savedFractal);
+    bool haveSaved = loadSettings(settingsPath, savedCenterReal, savedCenterImag, savedWidth, savedHeight, savedFractal);
     currentFractal = savedFractal;
 
     if (haveSaved && savedWidth > 0.0) {
         double halfW = savedWidth / 2.0;
-        double heightSpan = savedWidth * (static_cast<double>(HEIGHT) / static_cast<double>(WIDTH));
+        double heightSpan = savedHeight > 0.0 ? savedHeight
+                                              : savedWidth * (static_cast<double>(HEIGHT) / static_cast<double>(WIDTH));
         double halfH = heightSpan / 2.0;
-        realMin = savedCenterReal - halfW;
-        realMax = savedCenterReal + halfW;
-        imagMin = savedCenterImag - halfH;
-        imagMax = savedCenterImag + halfH;
+        fractalParams.originR = savedCenterReal;
+        fractalParams.originI = savedCenterImag;
+        realMin = -halfW;
+        realMax = halfW;
+        imagMin = -halfH;
+        imagMax = halfH;
     } else {
         realMin = INIT_REAL_MIN;
         realMax = INIT_REAL_MAX;
@@ -411,11 +3576,160 @@ int main() {
         // save initial state for next run
         double initCenterReal = (realMin + realMax) / 2.0;
         double initCenterImag = (imagMin + imagMax) / 2.0;
-        double initWidth = realMax - realMin;
-        saveSettings(settingsPath, initCenterReal, initCenterImag, initWidth, currentFractal);
+        saveSettings(settingsPath, initCenterReal, initCenterImag, realMax - realMin, imagMax - imagMin, currentFractal);
+    }
+
+    if (!options.posterPath.empty()) {
+        // Headless: the saved view at poster resolution, keeping its width and
+        // deriving the height span from the poster aspect ratio
+        if (!rendererHas(currentFractal, CAP_PER_PIXEL | CAP_DETERMINISTIC)) {
+            std::cerr << "Poster mode needs a per-pixel fractal (" << fractalsWith(CAP_PER_PIXEL | CAP_DETERMINISTIC)
+                      << "); saved fractal is " << currentFractal << "\n";
+            std::cout.rdbuf(coutBuf);
+            return 1;
+        }
+        double centerReal = (realMin + realMax) / 2.0;
+        double centerImag = (imagMin + imagMax) / 2.0;
+        double halfW = (realMax - realMin) / 2.0;
+        double halfH = halfW * static_cast<double>(options.posterHeight) / std::max(1, options.posterWidth);
+        ViewBounds view(centerReal - halfW, centerReal + halfW, centerImag - halfH, centerImag + halfH);
+        bool ok = renderPoster(options.posterPath, currentFractal, view, options.posterWidth, options.posterHeight,
+                               options.bandRows, MAX_ITER, fractalParams);
+        frameStream.close();
+        std::cout.rdbuf(coutBuf);
+        return ok ? 0 : 1;
+    }
+
+    if (!options.exportPath.empty()) {
+        // Headless: the saved view at export resolution, like a poster
+        if (!rendererHas(currentFractal, CAP_ITERATIONS)) {
+            std::cerr << "Iteration export needs an escape-time fractal (" << fractalsWith(CAP_ITERATIONS)
+                      << "); saved fractal is " << currentFractal << "\n";
+            std::cout.rdbuf(coutBuf);
+            return 1;
+        }
+        double centerReal = (realMin + realMax) / 2.0;
+        double centerImag = (imagMin + imagMax) / 2.0;
+        double halfW = (realMax - realMin) / 2.0;
+        double halfH = halfW * static_cast<double>(options.exportHeight) / std::max(1, options.exportWidth);
+        ViewBounds view(centerReal - halfW, centerReal + halfW, centerImag - halfH, centerImag + halfH);
+        bool ok = exportIterationFile(options.exportPath, currentFractal, view, options.exportWidth, options.exportHeight,
+                                      MAX_ITER, fractalParams, options.exportExtras);
+        frameStream.close();
+        std::cout.rdbuf(coutBuf);
+        return ok ? 0 : 1;
+    }
+
+    if (!options.buddhaPath.empty()) {
+        // Headless: the saved view at the requested size, height span from its aspect ratio
+        double centerReal = (realMin + realMax) / 2.0;
+        double centerImag = (imagMin + imagMax) / 2.0;
+        double halfW = (realMax - realMin) / 2.0;
+        double halfH = halfW * static_cast<double>(options.buddhaHeight) / std::max(1, options.buddhaWidth);
+        const double oR = fractalParams.originR.toDouble(), oI = fractalParams.originI.toDouble();
+        ViewBounds view(oR + centerReal - halfW, oR + centerReal + halfW, oI + centerImag - halfH, oI + centerImag + halfH);
+        bool ok = renderBuddhabrotFile(options.buddhaPath, view, options.buddhaWidth, options.buddhaHeight,
+                                       options.buddhaSamples);
+        frameStream.close();
+        std::cout.rdbuf(coutBuf);
+        return ok ? 0 : 1;
+    }
+
+    if (options.zoomVideo) {
+        // Headless: zoom from the restored view to the requested one and exit
+        // (the target is given in absolute coordinates; views are kept relative to the origin)
+        ViewBounds target = options.zoomTarget;
+        double halfH = (target.realMax - target.realMin) * (static_cast<double>(HEIGHT) / static_cast<double>(WIDTH)) / 2.0;
+        target.imagMin -= halfH; target.imagMax += halfH;
+        const double oR = fractalParams.originR.toDouble(), oI = fractalParams.originI.toDouble();
+        target.realMin -= oR; target.realMax -= oR;
+        target.imagMin -= oI; target.imagMax -= oI;
+        renderZoomVideo(frameStream, currentFractal, ViewBounds(realMin, realMax, imagMin, imagMax), target,
+                        options.zoomFrames, WIDTH, HEIGHT, MAX_ITER, fractalParams);
+        frameStream.close();
+        std::cout.rdbuf(coutBuf);
+        return 0;
+    }
+
+    // A replay starts from the recorded state, not the saved settings, and
+    // never writes settings back
+    const bool replaying = !options.replayPath.empty();
+    InputScript script;
+    if (replaying) {
+        if (!script.load(options.replayPath)) {
+            std::cout.rdbuf(coutBuf);
+            return 1;
+        }
+        if (script.width != WIDTH || script.height != HEIGHT) {
+            std::cerr << "Replay: recorded at " << script.width << "x" << script.height << ", viewer is " << WIDTH
+                      << "x" << HEIGHT << "\n";
+            std::cout.rdbuf(coutBuf);
+            return 1;
+        }
+        currentFractal = script.fractal;
+        fractalParams.originR = script.originR;
+        fractalParams.originI = script.originI;
+        fractalParams.antialias = script.antialias;
+        fractalParams.juliaRe = script.juliaRe;
+        fractalParams.juliaIm = script.juliaIm;
+        realMin = script.view.realMin; realMax = script.view.realMax;
+        imagMin = script.view.imagMin; imagMax = script.view.imagMax;
+    }
+    InputRecorder recorder;
+    if (!options.recordPath.empty() &&
+        !recorder.open(options.recordPath, WIDTH, HEIGHT, currentFractal, fractalParams,
+                       ViewBounds(realMin, realMax, imagMin, imagMax))) {
+        std::cout.rdbuf(coutBuf);
+        return 1;
+    }
+
+    // Settled views form a back/forward history, persisted next to the
+    // settings (not in a replay, which starts with an empty one). State files
+    // are written off the UI thread.
+    const std::string historyPath = "C:/_AI/002/view_history.txt";
+    ViewHistory history;
+    if (!replaying) history.load(historyPath);
+    FrameHistoryCache frameHistory(static_cast<size_t>(options.historyMb) * 1024 * 1024);
+    AsyncFileWriter fileWriter;
+    auto persistHistory = [&]() {
+        if (!replaying) fileWriter.write(historyPath, history.serialize());
+    };
+
+    // Persistent tile cache on a lattice anchored at the default view, so the
+    // default view (startup, R, mode switches) comes straight from disk. A
+    // replay never uses it: it starts from an empty private cache file, so
+    // runs compare and the session cache gets no replay tiles.
+    const std::string tileCachePath = replaying ? "C:/_AI/002/replay_tile_cache.bin" : "C:/_AI/002/tile_cache.bin";
+    if (replaying) std::remove(tileCachePath.c_str());
+    TileCache tileCache;
+    TileCache *tileCachePtr = nullptr;
+    if (options.tileCacheMb > 0 &&
+        tileCache.open(tileCachePath, static_cast<size_t>(options.tileCacheMb) * 1024 * 1024,
+                       INIT_REAL_MIN, INIT_IMAG_MAX,
+                       (INIT_REAL_MAX - INIT_REAL_MIN) / (WIDTH - 1), (INIT_IMAG_MAX - INIT_IMAG_MIN) / (HEIGHT - 1))) {
+        tileCachePtr = &tileCache;
+    }
+    uint64_t lastTileHits = 0, lastTileMisses = 0, lastTileBytes = 0;
+
+    // Buddhabrot density accumulated across frames while the view is still
+    BuddhabrotEngine buddhabrot;
+    RenderStats renderStats;
+    uint64_t lastBasePixels = 0, lastAaPixels = 0, lastAaSamples = 0;
+    double lastAaExtra = 0.0; // extra samples per base sample in the last measured frame
+    // Last completed escape-time frame and the background completion of the
+    // current zoom target (see reprojectPreview/ZoomCompletion)
+    IterationFrame lastFrame;
+    ZoomCompletion zoomCompletion;
+
+    // Create window (none for a headless replay)
+    std::unique_ptr<sf::RenderWindow> window;
+    if (!replaying) {
+        window.reset(new sf::RenderWindow(sf::VideoMode(WIDTH, HEIGHT), "Mandelbrot Fractal"));
+        window->setFramerateLimit(60);
     }
 
-    renderCurrent(currentFractal, image, WIDTH, HEIGHT, realMin, realMax, imagMin, imagMax, MAX_ITER);
+    renderCurrent(currentFractal, image, WIDTH, HEIGHT, realMin, realMax, imagMin, imagMax, MAX_ITER, tileCachePtr, fractalParams, &buddhabrot, &renderStats, 0, &lastFrame.iters);
+    lastFrame.describe(currentFractal, MAX_ITER, WIDTH, HEIGHT, ViewBounds(realMin, realMax, imagMin, imagMax), fractalParams);
     // Push pixels to the GPU texture (fast update) and draw via sprite to avoid flicker
     texture.update(image);
 
@@ -440,105 +3754,202 @@ int main() {
         overlay.setPosition(8.f, 8.f);
     }
     // Timing instrumentation
-    std::vector<PerfStats> perfStats(6); // index by fractal id (1..5)
+    std::vector<PerfStats> perfStats(FRACTAL_COUNT + 1); // index by fractal id (1..FRACTAL_COUNT)
     double lastRenderMs = 0.0;
     double lastFrameMs = 0.0;
     const std::string frameLogPath = "C:/_AI/002/frame_times.csv";
     const std::string summaryLogPath = "C:/_AI/002/frame_summary.csv";
-    std::vector<IntervalStats> intervalStats(6);
+    std::vector<IntervalStats> intervalStats(FRACTAL_COUNT + 1);
     sf::Clock summaryClock;
-    // Ensure CSV header exists
-    try {
-        std::ifstream test(frameLogPath);
-        if (!test.good()) {
-            std::ofstream hdr(frameLogPath, std::ios::trunc);
-            if (hdr.is_open()) hdr << "ts,fractal,render_ms,update_ms,display_ms,frame_ms\n";
-        }
-    } catch (...) {}
-    // Ensure summary CSV header exists
-    try {
-        std::ifstream tst(summaryLogPath);
-        if (!tst.good()) {
-            std::ofstream sh(summaryLogPath, std::ios::trunc);
-            if (sh.is_open()) sh << "ts,window_s,fractal,frames,min_ms,max_ms,avg_ms,total_ms\n";
-        }
-    } catch (...) {}
+    // per-frame scratch for the overlay and log lines, and heap-activity
+    // telemetry (allocations between consecutive measured frames)
+    FrameArena frameArena(64 * 1024);
+    uint64_t lastHeapAllocs = g_heapAllocs.load(), lastHeapBytes = g_heapBytes.load();
+    uint64_t lastFrameAllocs = 0, lastFrameAllocBytes = 0;
+    std::vector<char> overlayShown(4096, '\0');
+    sf::Clock overlayClock;
+    // Ensure CSV headers exist (files with older columns are moved aside)
+    ensureCsvHeader(frameLogPath, "ts,fractal,render_ms,update_ms,display_ms,frame_ms,tile_hits,tile_misses,tile_kb_read,tier,aa_pixels,aa_samples,input_events,retargets,renders_avoided,allocs,alloc_bytes");
+    ensureCsvHeader(summaryLogPath, "ts,window_s,fractal,frames,min_ms,max_ms,avg_ms,total_ms,"
+                                    "render_p50,render_p95,render_p99,render_p999,"
+                                    "upload_p50,upload_p95,upload_p99,upload_p999,"
+                                    "display_p50,display_p95,display_p99,display_p999,"
+                                    "frame_p50,frame_p95,frame_p99,frame_p999");
     // Logging queue + background writer
-    struct LogEntry { bool summary; std::string line; };
+    // Log lines are formatted into fixed-size entries of a preallocated ring,
+    // so logging a frame takes no heap allocation; when the writer falls a
+    // whole ring behind, lines are dropped and counted.
+    struct LogEntry { bool summary; int len; char line[768]; };
     std::mutex logMutex;
     std::condition_variable logCv;
-    std::queue<LogEntry> logQueue;
+    std::vector<LogEntry> logRing(256);
+    size_t logHead = 0, logCount = 0;
+    uint64_t logDropped = 0;
     bool logThreadStop = false;
+    auto pushLog = [&](const LogEntry &e) {
+        {
+            std::lock_guard<std::mutex> lk(logMutex);
+            if (logCount == logRing.size()) { ++logDropped; return; }
+            logRing[(logHead + logCount) % logRing.size()] = e;
+            ++logCount;
+        }
+        logCv.notify_one();
+    };
     std::thread writerThread([&]() {
         std::ofstream frameOut(frameLogPath, std::ios::app);
         std::ofstream sumOut(summaryLogPath, std::ios::app);
+        std::unique_ptr<LogEntry> e(new LogEntry());
         while (true) {
             std::unique_lock<std::mutex> lk(logMutex);
-            logCv.wait(lk, [&]{ return !logQueue.empty() || logThreadStop; });
-            while (!logQueue.empty()) {
-                LogEntry e = std::move(logQueue.front()); logQueue.pop();
+            logCv.wait(lk, [&]{ return logCount > 0 || logThreadStop; });
+            while (logCount > 0) {
+                *e = logRing[logHead];
+                logHead = (logHead + 1) % logRing.size();
+                --logCount;
                 lk.unlock();
                 try {
-                    if (e.summary) {
-                        if (sumOut.is_open()) { sumOut << e.line; }
+                    if (e->summary) {
+                        if (sumOut.is_open()) { sumOut.write(e->line, e->len); }
                     } else {
-                        if (frameOut.is_open()) { frameOut << e.line; }
+                        if (frameOut.is_open()) { frameOut.write(e->line, e->len); }
                     }
                 } catch (...) {}
                 lk.lock();
             }
-            if (logThreadStop && logQueue.empty()) break;
+            if (logThreadStop && logCount == 0) break;
         }
         try { if (frameOut.is_open()) frameOut.flush(); } catch(...){}
         try { if (sumOut.is_open()) sumOut.flush(); } catch(...){}
     });
-    // Animated zoom state: interpolate bounds over time for smooth zooming
+    // Animated zoom state: interpolate bounds over time for smooth zooming.
+    // progress() is the time fraction at loop time `now`; the path position
+    // eases from slope v0 to rest, so a retarget mid-flight continues at the
+    // current speed.
     struct ZoomAnim {
         bool active = false;
         float duration = 0.2f; // seconds
-        sf::Clock clock;
+        double v0 = 1.5;       // initial path slope; 1.5 = quick start from rest
+        double startTime = 0.0;
         double startRealMin = 0.0, startRealMax = 0.0, startImagMin = 0.0, startImagMax = 0.0;
         double targetRealMin = 0.0, targetRealMax = 0.0, targetImagMin = 0.0, targetImagMax = 0.0;
         void start(double srm, double srx, double sim, double six,
                    double trm, double trx, double tim, double tix,
-                   float dur) {
+                   float dur, double now, double slope = 1.5) {
             startRealMin = srm; startRealMax = srx; startImagMin = sim; startImagMax = six;
             targetRealMin = trm; targetRealMax = trx; targetImagMin = tim; targetImagMax = tix;
-            duration = dur; clock.restart(); active = true;
+            duration = dur; v0 = slope; startTime = now; active = true;
+        }
+        float progress(double now) const { return std::min(1.0f, static_cast<float>((now - startTime) / duration)); }
+        ViewBounds startView() const { return ViewBounds(startRealMin, startRealMax, startImagMin, startImagMax); }
+        ViewBounds targetView() const { return ViewBounds(targetRealMin, targetRealMax, targetImagMin, targetImagMax); }
+        ViewBounds viewAt(float u, int width, int height) const {
+            return zoomPathView(startView(), targetView(), zoomEase(u, v0), width, height);
+        }
+        // the view the animation settles on (bit-identical to its last step)
+        ViewBounds endView(int width, int height) const { return viewAt(1.0f, width, height); }
+        // Move the target of a running animation (or start one from `current`)
+        // keeping the current velocity along the new path
+        void retarget(const ViewBounds &current, const ViewBounds &target, float dur, double now) {
+            double slope = 1.5;
+            if (active && progress(now) < 1.0f) {
+                const double u = progress(now);
+                double velocity[3];
+                zoomPathTangent(startView(), targetView(), zoomEase(u, v0), current.realMax - current.realMin, velocity);
+                const double rate = zoomEaseSlope(u, v0) / duration;
+                for (int k = 0; k < 3; ++k) velocity[k] *= rate;
+                slope = zoomRetargetSlope(velocity, current, target, dur);
+            }
+            start(current.realMin, current.realMax, current.imagMin, current.imagMax,
+                  target.realMin, target.realMax, target.imagMin, target.imagMax, dur, now, slope);
         }
-        float progress() const { return std::min(1.0f, clock.getElapsedTime().asSeconds() / duration); }
     } zoomAnim;
 
+    // Input coalescing: wheel, zoom-key and click events of one frame are
+    // merged into a single target view, committed once per frame as at most
+    // one animation retarget and one precache request. Counters feed the
+    // overlay and frame_times.csv.
+    struct InputCoalescer {
+        bool pending = false;     // target differs from the committed view this frame
+        bool animate = false;     // pending change should animate (wheel/keys) rather than jump (click)
+        ViewBounds target;
+        float wheelDelta = 0.0f;  // |delta| summed over this frame's wheel events
+        int events = 0;           // view-changing events this frame
+        // cumulative telemetry; the frame log reports per-frame deltas
+        uint64_t inputEvents = 0, retargets = 0, rendersAvoided = 0, precacheAvoided = 0;
+        uint64_t lastInputEvents = 0, lastRetargets = 0, lastRendersAvoided = 0;
+
+        // the view further input builds on: the pending target, else where a
+        // running animation is heading, else the current view
+        ViewBounds &base(const ViewBounds &current, const ViewBounds *animTarget) {
+            if (!pending) { target = animTarget ? *animTarget : current; pending = true; }
+            return target;
+        }
+        void clear() { pending = animate = false; wheelDelta = 0.0f; events = 0; }
+    } input;
+
     // Precache: compute N frames ahead in background for zoom animations
     struct Precache {
         std::mutex m;
-        std::thread worker;
-        std::atomic<bool> active{false};
-        std::atomic<bool> cancel{false};
         int frames = 0;
-        std::vector<sf::Image> images; // length == frames, may be empty until ready
+        std::vector<sf::Image> images; // length == frames, valid where ready
         std::vector<std::atomic<bool>> ready; // per-image ready flags
+        ZoomSequence seq;              // keyframes of the current wheel zoom
+        // the zoom being precached
+        int fractal = 0, width = 0, height = 0, maxIter = 0;
+        ViewBounds startView, targetView;
+        double slope = 0.0;
+        FractalParams params;
+        BackgroundTask task{[](void *c) { static_cast<Precache *>(c)->fill(); }, this};
 
-        void start(int nFrames) {
-            std::lock_guard<std::mutex> lk(m);
-            cancel = false;
-            if (active && worker.joinable()) {
-                // request cancel and join previous
-                cancel = true;
-                worker.join();
+        void start(int nFrames, int frac, const ViewBounds &s, const ViewBounds &t, double v0, int w, int h,
+                   int iter, const FractalParams &fp) {
+            stop();
+            {
+                std::lock_guard<std::mutex> lk(m);
+                frames = nFrames;
+                // images, flags and keyframes are kept from zoom to zoom so
+                // their storage is reused; only the flags are reset
+                if (images.size() != static_cast<size_t>(frames)) {
+                    images.resize(frames);
+                    std::vector<std::atomic<bool>>(frames).swap(ready); // value-initialized to false
+                }
+                for (auto &r : ready) r = false;
+                fractal = frac; startView = s; targetView = t; slope = v0;
+                width = w; height = h; maxIter = iter; params = fp;
             }
-            frames = nFrames;
-            images.assign(frames, sf::Image());
-            ready.assign(frames, false);
-            active = true;
+            task.start();
         }
 
+        // Cancel the task and drop cached frames. Waits outside the lock,
+        // since the task takes `m` to publish each image.
         void stop() {
+            task.cancel();
             std::lock_guard<std::mutex> lk(m);
-            if (active) {
-                cancel = true;
-                if (worker.joinable()) worker.join();
-                active = false;
+            frames = 0;
+        }
+
+        void fill() {
+            // escape-time frames are resampled from one keyframe (a wheel
+            // step is well under an octave). Not antialiased: each frame is
+            // on screen for a few milliseconds and the resampling filters it.
+            const bool useKeyframes = rendererHas(fractal, CAP_PER_PIXEL | CAP_DETERMINISTIC);
+            params.antialias = false;
+            if (useKeyframes) seq.init(startView, targetView, width, height, fractal, maxIter, params);
+            for (int i = 0; i < frames && !task.cancelled(); ++i) {
+                // frame i is shown from time fraction i/N on
+                double p = zoomEase(static_cast<double>(i + 1) / static_cast<double>(frames), slope);
+                // rendered in place: the loop does not read an image before
+                // its ready flag is set
+                sf::Image &img = images[i];
+                if (useKeyframes) {
+                    seq.renderFrame(p, img);
+                } else {
+                    ViewBounds v = zoomPathView(startView, targetView, p, width, height);
+                    clearImage(img, width, height, sf::Color::Black);
+                    renderCurrent(fractal, img, width, height, v.realMin, v.realMax, v.imagMin, v.imagMax, maxIter, nullptr, params);
+                }
+                std::lock_guard<std::mutex> lk(m);
+                ready[i] = true;
             }
         }
 
@@ -553,21 +3964,106 @@ int main() {
             return &images[idx];
         }
     } precache;
-    
+
+    // Frame-to-frame intervals (display to display, so stalls in event
+    // handling count too) feed the latency histograms and the live graph
+    const int FRAME_GRAPH_LEN = 120;
+    std::vector<float> frameGraph(FRAME_GRAPH_LEN, 0.0f);
+    int frameGraphPos = 0;
+    sf::VertexArray frameGraphBars(sf::Lines);
+    auto lastDisplay = std::chrono::high_resolution_clock::now();
+    auto noteDisplayed = [&]() {
+        auto now = std::chrono::high_resolution_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(now - lastDisplay).count();
+        lastDisplay = now;
+        if (currentFractal >= 1 && currentFractal <= FRACTAL_COUNT) {
+            perfStats[currentFractal].latency.frame.record(ms);
+            intervalStats[currentFractal].latency.frame.record(ms);
+        }
+        frameGraph[frameGraphPos] = static_cast<float>(ms);
+        frameGraphPos = (frameGraphPos + 1) % FRAME_GRAPH_LEN;
+    };
+
+    // View history. `image` holds the complete frame of completeState when
+    // frameComplete; a frame restored from the cache is kept (not rendered
+    // again) while the view stays on it. A view shown complete for
+    // HISTORY_DWELL seconds becomes a history entry.
+    const double HISTORY_DWELL = 0.5;
+    ViewState completeState, settledState;
+    bool frameComplete = false, holdRestored = false;
+    bool debugSavePending = false; // save the next complete frame (fractal switch)
+    double settledSince = 0.0;
+    auto currentState = [&]() {
+        return ViewState(currentFractal, ViewBounds(realMin, realMax, imagMin, imagMax), fractalParams);
+    };
+    // cache the frame on screen when it is the complete frame of `s`
+    auto storeFrame = [&](const ViewState &s) {
+        if (!frameComplete || completeState != s) return;
+        const bool withIters = lastFrame.compatible(s.fractal, MAX_ITER, fractalParams) &&
+                               lastFrame.view.realMin == s.view.realMin && lastFrame.view.realMax == s.view.realMax &&
+                               lastFrame.view.imagMin == s.view.imagMin && lastFrame.view.imagMax == s.view.imagMax;
+        frameHistory.store(s, image, withIters ? &lastFrame : nullptr);
+    };
+    // Switch to `s`, dropping zooms in flight. A cached frame is swapped in
+    // at once (true); otherwise the next frame renders it.
+    auto goToState = [&](const ViewState &s) {
+        zoomAnim.active = false;
+        input.clear();
+        precache.stop();
+        zoomCompletion.stop();
+        currentFractal = s.fractal;
+        s.applyTo(fractalParams);
+        realMin = s.view.realMin; realMax = s.view.realMax;
+        imagMin = s.view.imagMin; imagMax = s.view.imagMax;
+        viewDirty = true; saveClock.restart();
+        if (!frameHistory.restore(s, image, lastFrame)) return false;
+        texture.update(image);
+        std::cout << "View history: cached frame restored (" << frameHistory.entries.size() << " cached, "
+                  << frameHistory.bytes / (1024 * 1024) << " MB)\n";
+        completeState = s;
+        frameComplete = holdRestored = true;
+        return true;
+    };
+
+    // Loop clock in seconds: wall time since the loop started, or in a replay
+    // a virtual clock that advances exactly one 60 Hz frame per iteration.
+    // Animations and held-key zoom run on it.
+    const double REPLAY_STEP = 1.0 / 60.0;
+    const auto loopStart = std::chrono::steady_clock::now();
+    double loopNow = 0.0, loopDt = 0.0;
+    uint64_t loopFrames = 0;
+    ReplayStats replayStats;
+    // events come from the window (recorded when --record is on) or the replay
+    auto nextEvent = [&](sf::Event &e) {
+        if (replaying) return script.poll(loopNow, e);
+        if (!window->pollEvent(e)) return false;
+        if (recorder.isOpen()) recorder.event(loopNow, e, currentFractal == JULIA);
+        return true;
+    };
+
     // Main loop
-    while (window.isOpen()) {
+    while (replaying ? !script.finished(loopNow) : window->isOpen()) {
+        frameArena.reset();
+        const auto frameBegin = std::chrono::steady_clock::now();
+        const double prevNow = loopNow;
+        loopNow = replaying ? loopFrames * REPLAY_STEP
+                            : std::chrono::duration<double>(frameBegin - loopStart).count();
+        loopDt = loopNow - prevNow;
+        ++loopFrames;
+        // image shown this iteration (the precache may substitute its own frame)
+        const sf::Image *shownImage = &image;
         sf::Event event;
-        while (window.pollEvent(event)) {
+        while (nextEvent(event)) {
             if (event.type == sf::Event::Closed) {
                     // save pending changes before exit
                     if (viewDirty) {
-                        double centerReal = (realMin + realMax) / 2.0;
-                        double centerImag = (imagMin + imagMax) / 2.0;
-                        double width = (realMax - realMin);
-                        saveSettings(settingsPath, centerReal, centerImag, width, currentFractal);
+                        DD centerReal = fractalParams.originR + (realMin + realMax) / 2.0;
+                        DD centerImag = fractalParams.originI + (imagMin + imagMax) / 2.0;
+                        fileWriter.write(settingsPath, settingsText(centerReal, centerImag, realMax - realMin,
+                                                                    imagMax - imagMin, currentFractal));
                         viewDirty = false;
                     }
-                    window.close();
+                    window->close();
                 }
             // Mouse left click: recenter the view on the clicked complex coordinate
             else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
@@ -578,36 +4074,52 @@ int main() {
                 // Pixel Y=0 is the top of the window; map that to imagMax (top of complex plane)
                 double clickedImag = pixelToImag(my, HEIGHT, imagMin, imagMax);
 
-                double halfW = (realMax - realMin) / 2.0;
-                double halfH = (imagMax - imagMin) / 2.0;
-
-                realMin = clickedReal - halfW;
-                realMax = clickedReal + halfW;
-                imagMin = clickedImag - halfH;
-                imagMax = clickedImag + halfH;
+                // Pan by whole pixels (the clicked point lands within half a
+                // pixel of the center) so a tile-aligned view stays aligned.
+                // The pan applies to this frame's target; with no zoom in
+                // flight it takes effect immediately when input is committed.
+                const ViewBounds animTarget = zoomAnim.targetView();
+                ViewBounds &t = input.base(ViewBounds(realMin, realMax, imagMin, imagMax),
+                                           zoomAnim.active ? &animTarget : nullptr);
+                double stepR = (t.realMax - t.realMin) / (WIDTH - 1);
+                double stepI = (t.imagMax - t.imagMin) / (HEIGHT - 1);
+                double shiftX = static_cast<double>(std::lround(mx - (WIDTH - 1) / 2.0));
+                double shiftY = static_cast<double>(std::lround(my - (HEIGHT - 1) / 2.0));
+                t.realMin += shiftX * stepR;
+                t.realMax += shiftX * stepR;
+                t.imagMin -= shiftY * stepI;
+                t.imagMax -= shiftY * stepI;
+                input.events++;
+                input.inputEvents++;
 
                 // Diagnostic: log the click mapping and resulting bounds so we can verify correctness
                 std::cout << "MouseClick px=(" << mx << "," << my << ") -> complex=(" << clickedReal << "," << clickedImag << ")\n";
-                std::cout << "New bounds after click: [" << realMin << "," << realMax << "," << imagMin << "," << imagMax << "]\n";
+                std::cout << "New bounds after click: [" << t.realMin << "," << t.realMax << "," << t.imagMin << "," << t.imagMax << "]\n";
 
                 // Persist click info to a simple log for detached runs
                 try {
                     std::ofstream clog("C:/_AI/002/clicks.log", std::ios::app);
                     if (clog.is_open()) {
                         clog << "MouseClick px=(" << mx << "," << my << ") -> complex=(" << clickedReal << "," << clickedImag << ") ";
-                        clog << "bounds=[" << realMin << "," << realMax << "," << imagMin << "," << imagMax << "]\n";
+                        clog << "bounds=[" << t.realMin << "," << t.realMax << "," << t.imagMin << "," << t.imagMax << "]\n";
                         clog.close();
                     }
                 } catch (...) {
                     // ignore file errors in diagnostics
                 }
 
-                renderCurrent(currentFractal, image, WIDTH, HEIGHT, realMin, realMax, imagMin, imagMax, MAX_ITER);
-                texture.update(image);
+                // rendered once by the frame below, however many clicks arrive
+                input.rendersAvoided++;
                 // mark dirty and debounce save
                 viewDirty = true;
                 saveClock.restart();
             }
+            // Mouse move in Julia mode: c follows the cursor over the default
+            // (Mandelbrot parameter plane) view; the idle loop re-renders
+            else if (event.type == sf::Event::MouseMoved && currentFractal == JULIA) {
+                fractalParams.juliaRe = pixelToReal(event.mouseMove.x, WIDTH, INIT_REAL_MIN, INIT_REAL_MAX);
+                fractalParams.juliaIm = pixelToImag(event.mouseMove.y, HEIGHT, INIT_IMAG_MIN, INIT_IMAG_MAX);
+            }
             // Mouse wheel scroll: zoom centered at mouse cursor
             else if (event.type == sf::Event::MouseWheelScrolled) {
                 if (event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel) {
@@ -615,64 +4127,32 @@ int main() {
                     int mx = static_cast<int>(event.mouseWheelScroll.x);
                     int my = static_cast<int>(event.mouseWheelScroll.y);
 
+                    // Zoom the frame's pending target (where earlier events of
+                    // this frame or a running animation are heading), so a
+                    // flick of several events becomes one compound zoom
+                    const ViewBounds animTarget = zoomAnim.targetView();
+                    ViewBounds &t = input.base(ViewBounds(realMin, realMax, imagMin, imagMax),
+                                               zoomAnim.active ? &animTarget : nullptr);
+
                     // Compute zoom factor from delta; using a smooth exponential scale
                     double wheelZoomFactor = std::pow(0.98, delta);
 
                     // Map the pixel under the cursor to complex coordinates
-                    double clickR = pixelToReal(mx, WIDTH, realMin, realMax);
-                    double clickI = pixelToImag(my, HEIGHT, imagMin, imagMax);
+                    double clickR = pixelToReal(mx, WIDTH, t.realMin, t.realMax);
+                    double clickI = pixelToImag(my, HEIGHT, t.imagMin, t.imagMax);
 
                     // Compute target bounds (zoom around clicked complex point)
-                    double trgRealMin = clickR + (realMin - clickR) * wheelZoomFactor;
-                    double trgRealMax = clickR + (realMax - clickR) * wheelZoomFactor;
+                    double trgRealMin = clickR + (t.realMin - clickR) * wheelZoomFactor;
+                    double trgRealMax = clickR + (t.realMax - clickR) * wheelZoomFactor;
                     // Keep aspect ratio by calculating half-height from target real width
                     double trgWidth = trgRealMax - trgRealMin;
                     double trgHalfH = trgWidth * (static_cast<double>(HEIGHT) / static_cast<double>(WIDTH)) / 2.0;
                     double trgCenterI = clickI;
-                    double trgImagMin = trgCenterI - trgHalfH;
-                    double trgImagMax = trgCenterI + trgHalfH;
-
-                    // Start an animated transition for smooth zoom (duration tuned by delta)
-                    float dur = std::min(0.3f, std::max(0.06f, 0.08f * std::abs(delta)));
-                    zoomAnim.start(realMin, realMax, imagMin, imagMax,
-                                   trgRealMin, trgRealMax, trgImagMin, trgImagMax,
-                                   dur);
-                    // Kick off precache of intermediate frames (15 ahead)
-                    const int PRECACHE_FRAMES = 15;
-                    precache.start(PRECACHE_FRAMES);
-                    // Spawn worker to fill precache images
-                    precache.worker = std::thread([=, &precache, &currentFractal, &MAX_ITER]() mutable {
-                        // compute per-frame bounds and render into images
-                        double srm = realMin, srx = realMax, sim = imagMin, six = imagMax;
-                        double trm = trgRealMin, trx = trgRealMax, tim = trgImagMin, tix = trgImagMax;
-                        double startW = srx - srm;
-                        double targetW = trx - trm;
-                        for (int i = 0; i < PRECACHE_FRAMES && !precache.cancel; ++i) {
-                            float p = static_cast<float>(i + 1) / static_cast<float>(PRECACHE_FRAMES);
-                            double curW = 0.0;
-                            if (startW > 0.0 && targetW > 0.0) curW = startW * std::pow(targetW / startW, p);
-                            else curW = srx + (trx - srx) * p;
-                            double startCenterR = (srm + srx) / 2.0;
-                            double targetCenterR = (trm + trx) / 2.0;
-                            double centerR = startCenterR + (targetCenterR - startCenterR) * p;
-                            double startCenterI = (sim + six) / 2.0;
-                            double targetCenterI = (tim + tix) / 2.0;
-                            double centerI = startCenterI + (targetCenterI - startCenterI) * p;
-                            double halfW = curW / 2.0;
-                            double halfH = curW * (static_cast<double>(HEIGHT) / static_cast<double>(WIDTH)) / 2.0;
-                            double rmin = centerR - halfW; double rmax = centerR + halfW;
-                            double imin = centerI - halfH; double imax = centerI + halfH;
-                            sf::Image img;
-                            img.create(WIDTH, HEIGHT, sf::Color::Black);
-                            renderCurrent(currentFractal, img, WIDTH, HEIGHT, rmin, rmax, imin, imax, MAX_ITER);
-                            {
-                                std::lock_guard<std::mutex> lk(precache.m);
-                                if (i < (int)precache.images.size()) precache.images[i] = std::move(img);
-                                precache.ready[i] = true;
-                            }
-                        }
-                        precache.active = false;
-                    });
+                    t = ViewBounds(trgRealMin, trgRealMax, trgCenterI - trgHalfH, trgCenterI + trgHalfH);
+                    input.animate = true;
+                    input.wheelDelta += std::abs(delta);
+                    input.events++;
+                    input.inputEvents++;
                     // mark dirty so we persist after animation completes
                     viewDirty = true; saveClock.restart();
                 }
@@ -682,81 +4162,46 @@ int main() {
                 // Numpad Add/Subtract or regular keys (Equal with Shift for '+', Hyphen/Dash for '-')
                 if (event.key.code == sf::Keyboard::Add || (event.key.code == sf::Keyboard::Equal && event.key.shift)) {
                     // start zoom-in (flags handled by polling below)
+                } else if (event.key.code == sf::Keyboard::A) {
+                    // Toggle adaptive antialiasing of the escape-time fractals
+                    fractalParams.antialias = !fractalParams.antialias;
+                    input.rendersAvoided++; // the frame below renders with the new setting
                 } else if (event.key.code == sf::Keyboard::R) {
-                    // Reset view to initial bounds
-                    realMin = -2.5;
-                    realMax = 1.0;
-                    imagMin = -1.0;
-                    imagMax = 1.0;
-
-                    renderCurrent(currentFractal, image, WIDTH, HEIGHT, realMin, realMax, imagMin, imagMax, MAX_ITER);
-                    texture.update(image);
-                    // mark dirty for reset state and debounce save
-                    {
-                        viewDirty = true;
-                        saveClock.restart();
-                    }
-                } else if (event.key.code == sf::Keyboard::Num1) {
-                    currentFractal = MADELBROT;
-                    // Reset view to initial defaults when switching fractal
-                    realMin = INIT_REAL_MIN;
-                    realMax = INIT_REAL_MAX;
-                    imagMin = INIT_IMAG_MIN;
-                    imagMax = INIT_IMAG_MAX;
-                    renderCurrent(currentFractal, image, WIDTH, HEIGHT, realMin, realMax, imagMin, imagMax, MAX_ITER);
-                    texture.update(image);
-                    // mark dirty and debounce save for fractal change
-                    viewDirty = true; saveClock.restart();
-                    // debug: save current rendered image for inspection
-                    image.saveToFile("C:/_AI/002/debug_fractal_1.png");
-                } else if (event.key.code == sf::Keyboard::Num2) {
-                    currentFractal = SIERPINSKI;
-                    // Reset view to initial defaults when switching fractal
-                    realMin = INIT_REAL_MIN;
-                    realMax = INIT_REAL_MAX;
-                    imagMin = INIT_IMAG_MIN;
-                    imagMax = INIT_IMAG_MAX;
-                    renderCurrent(currentFractal, image, WIDTH, HEIGHT, realMin, realMax, imagMin, imagMax, MAX_ITER);
-                    texture.update(image);
-                    viewDirty = true; saveClock.restart();
-                    image.saveToFile("C:/_AI/002/debug_fractal_2.png");
-                } else if (event.key.code == sf::Keyboard::Num3) {
-                    currentFractal = KOCH;
-                    // Reset view to initial defaults when switching fractal
-                    realMin = INIT_REAL_MIN;
-                    realMax = INIT_REAL_MAX;
-                    imagMin = INIT_IMAG_MIN;
-                    imagMax = INIT_IMAG_MAX;
-                    // cancel any precache when switching fractal
-                    precache.stop();
-                    renderCurrent(currentFractal, image, WIDTH, HEIGHT, realMin, realMax, imagMin, imagMax, MAX_ITER);
-                    texture.update(image);
-                    viewDirty = true; saveClock.restart();
-                    image.saveToFile("C:/_AI/002/debug_fractal_3.png");
-                } else if (event.key.code == sf::Keyboard::Num4) {
-                    currentFractal = MENGER;
-                    // Reset view to initial defaults when switching fractal
-                    realMin = INIT_REAL_MIN;
-                    realMax = INIT_REAL_MAX;
-                    imagMin = INIT_IMAG_MIN;
-                    imagMax = INIT_IMAG_MAX;
-                    precache.stop();
-                    renderCurrent(currentFractal, image, WIDTH, HEIGHT, realMin, realMax, imagMin, imagMax, MAX_ITER);
-                    texture.update(image);
-                    viewDirty = true; saveClock.restart();
-                    image.saveToFile("C:/_AI/002/debug_fractal_4.png");
-                } else if (event.key.code == sf::Keyboard::Num5) {
-                    currentFractal = DRAGON;
-                    // Reset view to initial defaults when switching fractal
-                    realMin = INIT_REAL_MIN;
-                    realMax = INIT_REAL_MAX;
-                    imagMin = INIT_IMAG_MIN;
-                    imagMax = INIT_IMAG_MAX;
-                    precache.stop();
-                    renderCurrent(currentFractal, image, WIDTH, HEIGHT, realMin, realMax, imagMin, imagMax, MAX_ITER);
-                    texture.update(image);
-                    viewDirty = true; saveClock.restart();
-                    image.saveToFile("C:/_AI/002/debug_fractal_5.png");
+                    // Reset view to initial bounds, from the frame cache when
+                    // it is there; otherwise the frame below renders it
+                    const ViewState now = currentState();
+                    storeFrame(now);
+                    ViewState reset = now;
+                    reset.view = ViewBounds(-2.5, 1.0, -1.0, 1.0);
+                    reset.originR = reset.originI = DD();
+                    goToState(reset);
+                    input.rendersAvoided++;
+                } else if (event.key.code == sf::Keyboard::Left || event.key.code == sf::Keyboard::Backspace ||
+                           event.key.code == sf::Keyboard::Right ||
+                           ((event.key.code == sf::Keyboard::Z || event.key.code == sf::Keyboard::Y) && event.key.control)) {
+                    // Back (Left, Backspace, Ctrl+Z) / forward (Right, Ctrl+Y)
+                    // through the view history
+                    const bool back = event.key.code != sf::Keyboard::Right && event.key.code != sf::Keyboard::Y;
+                    const ViewState now = currentState();
+                    storeFrame(now);
+                    ViewState to;
+                    if (back ? history.back(now, to) : history.forward(now, to)) goToState(to);
+                    persistHistory();
+                } else if (event.key.code >= sf::Keyboard::Num1 && event.key.code <= sf::Keyboard::Num9 &&
+                           isRegisteredFractal(event.key.code - sf::Keyboard::Num0)) {
+                    // Number keys select the fractal with that id, at the
+                    // initial default view (cancelling any precache), from
+                    // the frame cache when it is there; otherwise the frame
+                    // below renders it
+                    const ViewState now = currentState();
+                    storeFrame(now);
+                    ViewState to = now;
+                    to.fractal = event.key.code - sf::Keyboard::Num0;
+                    to.view = ViewBounds(INIT_REAL_MIN, INIT_REAL_MAX, INIT_IMAG_MIN, INIT_IMAG_MAX);
+                    to.originR = to.originI = DD();
+                    goToState(to);
+                    input.rendersAvoided++;
+                    debugSavePending = true;
                 } else if (event.key.code == sf::Keyboard::Subtract || event.key.code == sf::Keyboard::Hyphen) {
                     // start zoom-out
                 }
@@ -768,45 +4213,89 @@ int main() {
         static bool zoomInPressed = false;
         static bool zoomOutPressed = false;
         // update flags using real-time keyboard state so both left/right and text variants work
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Add) || (sf::Keyboard::isKeyPressed(sf::Keyboard::Equal) && sf::Keyboard::isKeyPressed(sf::Keyboard::LShift))) {
-            zoomInPressed = true;
+        if (replaying) {
+            zoomInPressed = script.zoomIn;
+            zoomOutPressed = script.zoomOut;
         } else {
-            // if Add not pressed and Equal+Shift not pressed, clear zoomIn
-            zoomInPressed = false;
+            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Add) || (sf::Keyboard::isKeyPressed(sf::Keyboard::Equal) && sf::Keyboard::isKeyPressed(sf::Keyboard::LShift))) {
+                zoomInPressed = true;
+            } else {
+                // if Add not pressed and Equal+Shift not pressed, clear zoomIn
+                zoomInPressed = false;
+            }
+            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Subtract) || sf::Keyboard::isKeyPressed(sf::Keyboard::Hyphen)) {
+                zoomOutPressed = true;
+            } else {
+                zoomOutPressed = false;
+            }
+            if (recorder.isOpen()) recorder.hold(loopNow, zoomInPressed, zoomOutPressed);
         }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Subtract) || sf::Keyboard::isKeyPressed(sf::Keyboard::Hyphen)) {
-            zoomOutPressed = true;
-        } else {
-            zoomOutPressed = false;
-        }
-
-        // continuous zoom timer: apply zoom every 50ms while key is held
-        static sf::Clock zoomClock;
-        const float zoomIntervalSec = 0.05f; // 50 ms
-        if ((zoomInPressed || zoomOutPressed) && zoomClock.getElapsedTime().asSeconds() >= zoomIntervalSec) {
-            // When the user holds zoom keys, kick off short animated zoom steps
-            if (!zoomAnim.active) {
-                double zoomFactor = 1.0;
-                if (zoomInPressed && !zoomOutPressed) zoomFactor = 0.98; // zoom in 2%
-                else if (zoomOutPressed && !zoomInPressed) zoomFactor = 1.02; // zoom out 2%
-
-                double centerReal = (realMin + realMax) / 2.0;
-                double centerImag = (imagMin + imagMax) / 2.0;
-                double trgRealMin = centerReal - (centerReal - realMin) * zoomFactor;
-                double trgRealMax = centerReal + (realMax - centerReal) * zoomFactor;
-                double trgWidth = trgRealMax - trgRealMin;
-                double trgHalfH = trgWidth * (static_cast<double>(HEIGHT) / static_cast<double>(WIDTH)) / 2.0;
-                double trgImagMin = centerImag - trgHalfH;
-                double trgImagMax = centerImag + trgHalfH;
-
-                // short duration for smooth continuous feel
-                zoomAnim.start(realMin, realMax, imagMin, imagMax,
-                               trgRealMin, trgRealMax, trgImagMin, trgImagMax,
-                               0.06f);
-                // mark dirty; save after animation
-                viewDirty = true; saveClock.restart();
-            }
-            zoomClock.restart();
+
+        // Held zoom keys move the target continuously (2% per 50 ms, scaled
+        // by the frame time) instead of restarting short animations
+        const double keyDt = std::min(0.1, loopDt);
+        const bool zoomKeyHeld = zoomInPressed != zoomOutPressed;
+        if (zoomKeyHeld) {
+            double zoomFactor = std::pow(zoomInPressed ? 0.98 : 1.02, keyDt / 0.05);
+            const ViewBounds animTarget = zoomAnim.targetView();
+            ViewBounds &t = input.base(ViewBounds(realMin, realMax, imagMin, imagMax),
+                                       zoomAnim.active ? &animTarget : nullptr);
+            double centerReal = (t.realMin + t.realMax) / 2.0;
+            double centerImag = (t.imagMin + t.imagMax) / 2.0;
+            double trgHalfW = (t.realMax - t.realMin) * zoomFactor / 2.0;
+            double trgHalfH = trgHalfW * (static_cast<double>(HEIGHT) / static_cast<double>(WIDTH));
+            t = ViewBounds(centerReal - trgHalfW, centerReal + trgHalfW, centerImag - trgHalfH, centerImag + trgHalfH);
+            input.animate = true;
+            // mark dirty; save after animation
+            viewDirty = true; saveClock.restart();
+        }
+
+        // Commit this frame's input: one jump or one retarget, one precache
+        // request and one background completion at most
+        static bool completionDeferred = false;
+        if (input.pending) {
+            const ViewBounds current(realMin, realMax, imagMin, imagMax);
+            if (!input.animate && !zoomAnim.active) {
+                // clicks with nothing in flight: jump, as before
+                realMin = input.target.realMin; realMax = input.target.realMax;
+                imagMin = input.target.imagMin; imagMax = input.target.imagMax;
+            } else {
+                // wheel duration tuned by the frame's total delta; held keys
+                // use short steps that are retargeted every frame
+                float dur = input.wheelDelta > 0.0f ? std::min(0.3f, std::max(0.06f, 0.08f * input.wheelDelta)) : 0.06f;
+                zoomAnim.retarget(current, input.target, dur, loopNow);
+                input.retargets++;
+                // Finish the target view in the background, reusing the
+                // samples of the last frame that it lands on exactly. Not
+                // while a zoom key is held: the target moves every frame.
+                completionDeferred = zoomKeyHeld;
+                if (!zoomKeyHeld && rendererHas(currentFractal, CAP_ITERATIONS)) {
+                    zoomCompletion.start(lastFrame, currentFractal, MAX_ITER,
+                                         zoomAnim.endView(WIDTH, HEIGHT), WIDTH, HEIGHT, fractalParams);
+                }
+                if (input.wheelDelta > 0.0f && !rendererHas(currentFractal, CAP_PROGRESSIVE)) {
+                    // one precache of intermediate frames (15 ahead) for all
+                    // of this frame's wheel events. Not for progressive
+                    // renderers: a one-off Buddhabrot frame costs more than
+                    // the engine's own frame and competes with it for cores
+                    input.precacheAvoided += input.events > 1 ? input.events - 1 : 0;
+                    const int PRECACHE_FRAMES = 15;
+                    precache.start(PRECACHE_FRAMES, currentFractal, zoomAnim.startView(), zoomAnim.targetView(),
+                                   zoomAnim.v0, WIDTH, HEIGHT, MAX_ITER, fractalParams);
+                } else {
+                    // drop frames precached for an earlier wheel zoom so
+                    // they are not shown along the new path
+                    precache.stop();
+                }
+            }
+            input.clear();
+        } else if (completionDeferred && !zoomKeyHeld && zoomAnim.active) {
+            // zoom key released mid-animation: the target is final now
+            completionDeferred = false;
+            if (rendererHas(currentFractal, CAP_ITERATIONS)) {
+                zoomCompletion.start(lastFrame, currentFractal, MAX_ITER,
+                                     zoomAnim.endView(WIDTH, HEIGHT), WIDTH, HEIGHT, fractalParams);
+            }
         }
 
         // Handle smooth zooming via mouse wheel (centered on cursor)
@@ -815,87 +4304,143 @@ int main() {
 
         // update overlay text with zoom and center and current fractal
         if (fontLoaded) {
-            double centerReal = (realMin + realMax) / 2.0;
-            double centerImag = (imagMin + imagMax) / 2.0;
+            DD centerReal = fractalParams.originR + (realMin + realMax) / 2.0;
+            DD centerImag = fractalParams.originI + (imagMin + imagMax) / 2.0;
             double currentWidth = (realMax - realMin);
             double initialWidth = (INIT_REAL_MAX - INIT_REAL_MIN);
             double zoomFactor = initialWidth / currentWidth; // 1.0 = initial
 
-            std::ostringstream oss;
-            oss << std::fixed << std::setprecision(6);
-            oss << "Zoom: " << zoomFactor << "x (" << std::setprecision(2) << (zoomFactor * 100.0) << "%)\n";
-            oss << std::setprecision(8);
-            oss << "Center: (" << centerReal << ", " << centerImag << ")\n";
-            const char *name = "MADELBROT";
-            if (currentFractal == SIERPINSKI) name = "Sierpinski";
-            else if (currentFractal == KOCH) name = "Koch";
-            else if (currentFractal == MENGER) name = "Menger";
-            else if (currentFractal == DRAGON) name = "Dragon";
-            oss << "Fractal: " << name;
+            ArenaText text(frameArena, overlayShown.size());
+            text.printf("Zoom: %.6fx (%.2f%%)\n", zoomFactor, zoomFactor * 100.0);
+            const int digits = currentWidth < 1e-5 ? 17 : 8;
+            text.printf("Center: (%.*f, %.*f)\n", digits, centerReal.toDouble(), digits, centerImag.toDouble());
+            text.printf("Fractal: %s", findRenderer(currentFractal).name);
+            if (currentFractal == JULIA) text.printf(" c=(%.*f, %.*f)", digits, fractalParams.juliaRe, digits, fractalParams.juliaIm);
+            if (rendererHas(currentFractal, CAP_PROGRESSIVE)) {
+                // still views keep accumulating: show how far they have got
+                text.printf("\nSamples: %.1fM orbits: %.1fM passes: %llu", buddhabrot.samples / 1e6,
+                            buddhabrot.orbits / 1e6, static_cast<unsigned long long>(buddhabrot.passes));
+            }
+            if (rendererHas(currentFractal, CAP_ITERATIONS)) {
+                text.printf("\nPrecision: %s",
+                            precisionTierName(escapePrecisionTier(realMin, realMax, imagMin, imagMax, WIDTH, HEIGHT)));
+                if (fractalParams.antialias) text.printf("\nAntialias (A): +%.2f%% samples", 100.0 * lastAaExtra);
+                else text.printf("\nAntialias (A): off");
+            }
             // Append timing stats when available
-            try {
-                std::ostringstream tss;
-                tss << std::fixed << std::setprecision(2);
-                double avg = 0.0, mn = 0.0, mx = 0.0;
-                if (currentFractal >= 1 && currentFractal < static_cast<int>(perfStats.size())) {
-                    avg = perfStats[currentFractal].avg();
-                    mn = perfStats[currentFractal].minMs < 1e9 ? perfStats[currentFractal].minMs : 0.0;
-                    mx = perfStats[currentFractal].maxMs;
-                }
-                tss << "\nRender(ms): last=" << lastRenderMs << " avg=" << avg << " min=" << mn << " max=" << mx;
-                tss << "\nFrame(ms): last=" << lastFrameMs;
-                oss << tss.str();
-            } catch (...) {}
-            overlay.setString(oss.str());
+            double avg = 0.0, mn = 0.0, mx = 0.0;
+            if (currentFractal >= 1 && currentFractal < static_cast<int>(perfStats.size())) {
+                avg = perfStats[currentFractal].avg();
+                mn = perfStats[currentFractal].minMs < 1e9 ? perfStats[currentFractal].minMs : 0.0;
+                mx = perfStats[currentFractal].maxMs;
+            }
+            text.printf("\nRender(ms): last=%.2f avg=%.2f min=%.2f max=%.2f", lastRenderMs, avg, mn, mx);
+            text.printf("\nFrame(ms): last=%.2f", lastFrameMs);
+            if (currentFractal >= 1 && currentFractal < static_cast<int>(perfStats.size())) {
+                const LatencyHistogram &fh = perfStats[currentFractal].latency.frame;
+                text.printf(" p50=%.2f p95=%.2f p99=%.2f p99.9=%.2f", fh.percentileMs(0.50), fh.percentileMs(0.95),
+                            fh.percentileMs(0.99), fh.percentileMs(0.999));
+            }
+            text.printf("\nInput: events=%llu retargets=%llu renders avoided=%llu precache restarts avoided=%llu",
+                        static_cast<unsigned long long>(input.inputEvents), static_cast<unsigned long long>(input.retargets),
+                        static_cast<unsigned long long>(input.rendersAvoided),
+                        static_cast<unsigned long long>(input.precacheAvoided));
+            if (tileCachePtr) {
+                uint64_t lookups = tileCache.hits + tileCache.misses;
+                text.printf("\nTiles: hit=%.2f%% read=%.2fMB cached=%llu", lookups ? 100.0 * tileCache.hits / lookups : 0.0,
+                            tileCache.bytesRead / (1024.0 * 1024.0),
+                            static_cast<unsigned long long>(tileCache.index.size()));
+            }
+            text.printf("\nHistory (Left/Right): %llu/%llu cached=%llu (%.1fMB) hits=%llu",
+                        static_cast<unsigned long long>(history.entries.empty() ? 0 : history.cursor + 1),
+                        static_cast<unsigned long long>(history.entries.size()),
+                        static_cast<unsigned long long>(frameHistory.entries.size()),
+                        frameHistory.bytes / (1024.0 * 1024.0), static_cast<unsigned long long>(frameHistory.hits));
+            text.printf("\nHeap/frame: allocs=%llu bytes=%llu arena=%lluKB log dropped=%llu",
+                        static_cast<unsigned long long>(lastFrameAllocs),
+                        static_cast<unsigned long long>(lastFrameAllocBytes),
+                        static_cast<unsigned long long>(frameArena.capacity / 1024),
+                        static_cast<unsigned long long>(logDropped));
+            // sf::Text::setString copies into heap-allocated strings and
+            // rebuilds its glyph vertices, so it only runs when the text changed
+            // and at most four times a second
+            if (overlayClock.getElapsedTime().asMilliseconds() >= 250 &&
+                std::strcmp(text.c_str(), overlayShown.data()) != 0) {
+                std::memcpy(overlayShown.data(), text.c_str(), text.len + 1);
+                overlay.setString(overlayShown.data());
+                overlayClock.restart();
+            }
+        }
+
+        // live frame-time graph along the bottom edge, oldest interval on the
+        // left; 1 px per ms with markers at 16.7 ms (60 Hz) and 33.3 ms (30 Hz)
+        {
+            const float x0 = 8.f, base = static_cast<float>(HEIGHT) - 8.f, maxBar = 60.f;
+            frameGraphBars.clear();
+            for (int i = 0; i < FRAME_GRAPH_LEN; ++i) {
+                float ms = frameGraph[(frameGraphPos + i) % FRAME_GRAPH_LEN];
+                sf::Color col = ms <= 17.f ? sf::Color(80, 220, 80) : (ms <= 34.f ? sf::Color(230, 200, 60) : sf::Color(230, 60, 60));
+                float x = x0 + 2.f * i;
+                frameGraphBars.append(sf::Vertex(sf::Vector2f(x, base), col));
+                frameGraphBars.append(sf::Vertex(sf::Vector2f(x, base - std::min(ms, maxBar)), col));
+            }
+            const float marks[] = {16.7f, 33.3f};
+            for (float m : marks) {
+                sf::Color col(255, 255, 255, 110);
+                frameGraphBars.append(sf::Vertex(sf::Vector2f(x0, base - m), col));
+                frameGraphBars.append(sf::Vertex(sf::Vector2f(x0 + 2.f * FRAME_GRAPH_LEN, base - m), col));
+            }
         }
 
-        // If an animated zoom is active, step it and render the intermediate view
+        // If an animated zoom is active, step it and show the intermediate
+        // view: a precached frame, else the last completed frame warped to it
+        // while that is still close in scale, else one render, which becomes
+        // the new source for warping. The final step is left to the measured
+        // render below rather than rendered twice.
         if (zoomAnim.active) {
-            float p = zoomAnim.progress();
-            // interpolate center linearly, interpolate width exponentially for natural zoom
-            double startW = zoomAnim.startRealMax - zoomAnim.startRealMin;
-            double targetW = zoomAnim.targetRealMax - zoomAnim.targetRealMin;
-            double curW = 0.0;
-            if (startW > 0.0 && targetW > 0.0) curW = startW * std::pow(targetW / startW, p);
-            else curW = zoomAnim.startRealMax + (zoomAnim.targetRealMax - zoomAnim.startRealMax) * p;
-
-            double startCenterR = (zoomAnim.startRealMin + zoomAnim.startRealMax) / 2.0;
-            double targetCenterR = (zoomAnim.targetRealMin + zoomAnim.targetRealMax) / 2.0;
-            double centerR = startCenterR + (targetCenterR - startCenterR) * p;
-
-            double startCenterI = (zoomAnim.startImagMin + zoomAnim.startImagMax) / 2.0;
-            double targetCenterI = (zoomAnim.targetImagMin + zoomAnim.targetImagMax) / 2.0;
-            double centerI = startCenterI + (targetCenterI - startCenterI) * p;
-
-            double halfW = curW / 2.0;
-            double halfH = curW * (static_cast<double>(HEIGHT) / static_cast<double>(WIDTH)) / 2.0;
-
-            realMin = centerR - halfW;
-            realMax = centerR + halfW;
-            imagMin = centerI - halfH;
-            imagMax = centerI + halfH;
-
-            // During an animated zoom try to use precached frame if available
-            if (zoomAnim.active) {
-                float p = zoomAnim.progress();
+            float p = zoomAnim.progress(loopNow);
+            ViewBounds cur = zoomAnim.viewAt(p, WIDTH, HEIGHT);
+            realMin = cur.realMin;
+            realMax = cur.realMax;
+            imagMin = cur.imagMin;
+            imagMax = cur.imagMax;
+
+            if (p >= 1.0f) {
+                zoomAnim.active = false;
+                input.rendersAvoided++;
+            } else {
+                replayStats.animFrames++;
                 int idx = static_cast<int>(std::floor(p * precache.frames));
                 if (idx < 0) idx = 0;
                 if (idx >= precache.frames) idx = precache.frames - 1;
                 const sf::Image *pre = nullptr;
-                if (precache.active && precache.isReadyIndex(idx)) pre = precache.getImage(idx);
+                if (precache.isReadyIndex(idx)) pre = precache.getImage(idx);
+                const double scale = lastFrame.valid()
+                    ? (realMax - realMin) / (lastFrame.view.realMax - lastFrame.view.realMin) : 0.0;
+                if (precache.frames > 0) {
+                    if (pre) replayStats.precacheHits++;
+                    else replayStats.precacheMisses++;
+                }
                 if (pre) {
                     texture.update(*pre);
+                    shownImage = pre;
+                } else if (lastFrame.compatible(currentFractal, MAX_ITER, fractalParams) && scale > 0.67 && scale < 1.5) {
+                    reprojectPreview(lastFrame, cur, WIDTH, HEIGHT, image);
+                    texture.update(image);
+                    replayStats.previews++;
+                    frameComplete = false;
                 } else {
-                    renderCurrent(currentFractal, image, WIDTH, HEIGHT, realMin, realMax, imagMin, imagMax, MAX_ITER);
+                    const bool keep = rendererHas(currentFractal, CAP_ITERATIONS);
+                    auto rstart = std::chrono::high_resolution_clock::now();
+                    renderCurrent(currentFractal, image, WIDTH, HEIGHT, realMin, realMax, imagMin, imagMax, MAX_ITER, tileCachePtr, fractalParams, &buddhabrot, &renderStats,
+                                  0, keep ? &lastFrame.iters : nullptr);
+                    replayStats.renders++;
+                    replayStats.renderMs += std::chrono::duration<double, std::milli>(
+                        std::chrono::high_resolution_clock::now() - rstart).count();
+                    if (keep) lastFrame.describe(currentFractal, MAX_ITER, WIDTH, HEIGHT, cur, fractalParams);
                     texture.update(image);
+                    frameComplete = false;
                 }
-            } else {
-                renderCurrent(currentFractal, image, WIDTH, HEIGHT, realMin, realMax, imagMin, imagMax, MAX_ITER);
-                texture.update(image);
-            }
-
-            if (p >= 1.0f) {
-                zoomAnim.active = false;
             }
         }
         
@@ -903,19 +4448,90 @@ int main() {
         // full-frame render+update+display per loop by tracking whether we
         // already displayed this iteration.
         static bool frameDisplayed = false;
+        if (!zoomAnim.active) {
+            // Keep the bounds relative to a nearby origin: once the center has
+            // drifted far from the origin compared with the view span, fold it
+            // into the double-double origin so no bits are lost at deep zoom
+            double centerReal = (realMin + realMax) / 2.0;
+            double centerImag = (imagMin + imagMax) / 2.0;
+            double span = std::min(realMax - realMin, imagMax - imagMin);
+            if (std::fabs(centerReal) > 16.0 * span || std::fabs(centerImag) > 16.0 * span) {
+                fractalParams.originR = fractalParams.originR + centerReal;
+                fractalParams.originI = fractalParams.originI + centerImag;
+                realMin -= centerReal; realMax -= centerReal;
+                imagMin -= centerImag; imagMax -= centerImag;
+                precache.stop();
+            }
+        }
+        // the Buddhabrot engine accumulates in the background only while shown
+        if (!rendererHas(currentFractal, CAP_PROGRESSIVE)) buddhabrot.stop();
         if (!zoomAnim.active) {
             // no animation active -> do a measured full-frame render/display
             auto frameStart = std::chrono::high_resolution_clock::now();
             auto rstart = frameStart;
-            renderCurrent(currentFractal, image, WIDTH, HEIGHT, realMin, realMax, imagMin, imagMax, MAX_ITER);
+            const ViewBounds view(realMin, realMax, imagMin, imagMax);
+            const ViewState state = currentState();
+            holdRestored = holdRestored && frameComplete && completeState == state &&
+                           rendererHas(currentFractal, CAP_DETERMINISTIC);
+            if (holdRestored) {
+                // restored from the view history: `image` already holds it
+            } else if (zoomCompletion.readyFor(currentFractal, MAX_ITER, view, fractalParams)) {
+                // the zoom target finished in the background: color it and
+                // make it the frame later zooms reproject from
+                colorizeIterations(image, zoomCompletion.frame, &renderStats);
+                std::cout << "Zoom completion: " << zoomCompletion.reused << " samples reused, "
+                          << zoomCompletion.computed << " computed" << std::endl;
+                replayStats.completions++;
+                replayStats.completionSamples += zoomCompletion.computed;
+                std::swap(lastFrame, zoomCompletion.frame);
+                zoomCompletion.stop();
+                frameComplete = true;
+                completeState = state;
+            } else if (zoomCompletion.pendingFor(currentFractal, MAX_ITER, view, fractalParams) &&
+                       lastFrame.compatible(currentFractal, MAX_ITER, fractalParams)) {
+                // still computing: keep showing the warped preview, no stall
+                reprojectPreview(lastFrame, view, WIDTH, HEIGHT, image);
+                replayStats.previews++;
+                frameComplete = false;
+            } else {
+                zoomCompletion.stop();
+                const bool keep = rendererHas(currentFractal, CAP_ITERATIONS);
+                renderCurrent(currentFractal, image, WIDTH, HEIGHT, realMin, realMax, imagMin, imagMax, MAX_ITER, tileCachePtr, fractalParams, &buddhabrot, &renderStats,
+                              0, keep ? &lastFrame.iters : nullptr);
+                replayStats.renders++;
+                if (keep) lastFrame.describe(currentFractal, MAX_ITER, WIDTH, HEIGHT, view, fractalParams);
+                frameComplete = true;
+                completeState = state;
+            }
+            if (debugSavePending && frameComplete) {
+                // debug: save the newly selected fractal's frame for inspection
+                image.saveToFile("C:/_AI/002/debug_fractal_" + std::to_string(currentFractal) + ".png");
+                debugSavePending = false;
+            }
+            // a view that stays complete on screen for HISTORY_DWELL seconds
+            // becomes the newest history entry, with its frame cached
+            if (state != settledState) {
+                settledState = state;
+                settledSince = loopNow;
+            } else if (frameComplete && completeState == state && loopNow - settledSince >= HISTORY_DWELL &&
+                       (!history.current() || *history.current() != state)) {
+                history.push(state);
+                storeFrame(state);
+                persistHistory();
+            }
             auto rend = std::chrono::high_resolution_clock::now();
             texture.update(image);
             auto rupdate = std::chrono::high_resolution_clock::now();
 
-            window.clear();
-            window.draw(sprite);
-            if (fontLoaded) window.draw(overlay);
-            window.display();
+            if (window) {
+                window->clear();
+                window->draw(sprite);
+                if (fontLoaded) window->draw(overlay);
+                window->draw(frameGraphBars);
+                window->display();
+            }
+            noteDisplayed();
+            if (frameStream.isOpen()) frameStream.push(image);
 
             auto fend = std::chrono::high_resolution_clock::now();
 
@@ -925,24 +4541,67 @@ int main() {
             double frameMs = std::chrono::duration<double, std::milli>(fend - frameStart).count();
 
             lastRenderMs = renderMs; lastFrameMs = frameMs;
-            if (currentFractal >= 1 && currentFractal < static_cast<int>(perfStats.size())) perfStats[currentFractal].add(renderMs);
+            replayStats.renderMs += renderMs;
+            // tile cache activity during this frame
+            uint64_t tileHits = tileCache.hits - lastTileHits;
+            uint64_t tileMisses = tileCache.misses - lastTileMisses;
+            uint64_t tileBytes = tileCache.bytesRead - lastTileBytes;
+            lastTileHits = tileCache.hits; lastTileMisses = tileCache.misses; lastTileBytes = tileCache.bytesRead;
+            // antialiasing work during this frame
+            uint64_t aaPixels = renderStats.aaPixels - lastAaPixels;
+            uint64_t aaSamples = renderStats.aaSamples - lastAaSamples;
+            uint64_t basePixels = renderStats.basePixels - lastBasePixels;
+            lastAaPixels = renderStats.aaPixels; lastAaSamples = renderStats.aaSamples; lastBasePixels = renderStats.basePixels;
+            lastAaExtra = basePixels ? static_cast<double>(aaSamples) / basePixels : 0.0;
+            // input coalescing since the last measured frame
+            uint64_t inputEvents = input.inputEvents - input.lastInputEvents;
+            uint64_t retargets = input.retargets - input.lastRetargets;
+            uint64_t rendersAvoided = input.rendersAvoided - input.lastRendersAvoided;
+            input.lastInputEvents = input.inputEvents; input.lastRetargets = input.retargets;
+            input.lastRendersAvoided = input.rendersAvoided;
+            if (currentFractal >= 1 && currentFractal < static_cast<int>(perfStats.size())) {
+                perfStats[currentFractal].add(renderMs);
+                FrameLatency &lat = perfStats[currentFractal].latency;
+                lat.render.record(renderMs); lat.upload.record(updateMs); lat.display.record(displayMs);
+            }
 
             // update interval stats for per-2s summary
             if (currentFractal >= 1 && currentFractal < static_cast<int>(intervalStats.size())) {
                 intervalStats[currentFractal].add(renderMs);
+                FrameLatency &lat = intervalStats[currentFractal].latency;
+                lat.render.record(renderMs); lat.upload.record(updateMs); lat.display.record(displayMs);
             }
 
-            // enqueue CSV log line for background writer
-            try {
+            // heap activity over the whole loop iteration since the last
+            // measured frame (counted before this frame's log line is queued)
+            const uint64_t heapAllocs = g_heapAllocs.load(std::memory_order_relaxed);
+            const uint64_t heapBytes = g_heapBytes.load(std::memory_order_relaxed);
+            lastFrameAllocs = heapAllocs - lastHeapAllocs;
+            lastFrameAllocBytes = heapBytes - lastHeapBytes;
+            lastHeapAllocs = heapAllocs; lastHeapBytes = heapBytes;
+
+            // enqueue CSV log line for background writer (replays report
+            // to replay_results.csv instead)
+            if (!replaying) {
                 auto ts = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-                std::ostringstream l;
-                l << ts << "," << currentFractal << "," << renderMs << "," << updateMs << "," << displayMs << "," << frameMs << "\n";
-                {
-                    std::lock_guard<std::mutex> lk(logMutex);
-                    logQueue.push(LogEntry{false, l.str()});
-                }
-                logCv.notify_one();
-            } catch (...) {}
+                LogEntry e;
+                e.summary = false;
+                e.len = std::snprintf(e.line, sizeof(e.line),
+                                      "%lld,%d,%g,%g,%g,%g,%llu,%llu,%llu,%s,%llu,%llu,%llu,%llu,%llu,%llu,%llu\n",
+                                      static_cast<long long>(ts), currentFractal, renderMs, updateMs, displayMs, frameMs,
+                                      static_cast<unsigned long long>(tileHits), static_cast<unsigned long long>(tileMisses),
+                                      static_cast<unsigned long long>(tileBytes / 1024),
+                                      rendererHas(currentFractal, CAP_ITERATIONS)
+                                          ? precisionTierName(escapePrecisionTier(realMin, realMax, imagMin, imagMax, WIDTH, HEIGHT))
+                                          : "n/a",
+                                      static_cast<unsigned long long>(aaPixels), static_cast<unsigned long long>(aaSamples),
+                                      static_cast<unsigned long long>(inputEvents), static_cast<unsigned long long>(retargets),
+                                      static_cast<unsigned long long>(rendersAvoided),
+                                      static_cast<unsigned long long>(lastFrameAllocs),
+                                      static_cast<unsigned long long>(lastFrameAllocBytes));
+                e.len = std::min(e.len, static_cast<int>(sizeof(e.line)) - 1);
+                if (e.len > 0) pushLog(e);
+            }
 
             // occasional console report every 60 frames
             if (perfStats[currentFractal].frames > 0 && perfStats[currentFractal].frames % 60 == 0) {
@@ -950,6 +4609,10 @@ int main() {
                 std::cout << "Perf fractal=" << currentFractal << " frames=" << ps.frames
                           << " avg_render_ms=" << ps.avg()
                           << " min=" << ps.minMs << " max=" << ps.maxMs << " last_frame_ms=" << frameMs << "\n";
+                if (frameStream.isOpen()) {
+                    std::cout << "Stream frames=" << frameStream.framesWritten << "/" << frameStream.framesPushed
+                              << " blocked_ms=" << frameStream.blockedMs << "\n";
+                }
             }
 
             frameDisplayed = true;
@@ -957,25 +4620,32 @@ int main() {
 
         // Periodic summary: every 2 seconds, write aggregated summary for each fractal
         if (summaryClock.getElapsedTime().asSeconds() >= 2.0f) {
-            try {
+            if (!replaying) {
                 auto ts = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
                 double windowS = summaryClock.getElapsedTime().asSeconds();
-                for (int f = 1; f <= 5; ++f) {
+                LogEntry e;
+                e.summary = true;
+                for (int f = 1; f <= FRACTAL_COUNT; ++f) {
                     const IntervalStats &is = intervalStats[f];
-                    std::ostringstream l;
+                    ArenaText l(frameArena, sizeof(e.line));
                     if (is.frames > 0) {
-                        l << ts << "," << windowS << "," << f << "," << is.frames << "," << is.minMs
-                          << "," << is.maxMs << "," << is.avg() << "," << is.totalMs << "\n";
+                        l.printf("%lld,%g,%d,%llu,%g,%g,%g,%g", static_cast<long long>(ts), windowS, f,
+                                 static_cast<unsigned long long>(is.frames), is.minMs, is.maxMs, is.avg(), is.totalMs);
                     } else {
-                        l << ts << "," << windowS << "," << f << ",0,0,0,0,0\n";
+                        l.printf("%lld,%g,%d,0,0,0,0,0", static_cast<long long>(ts), windowS, f);
                     }
-                    {
-                        std::lock_guard<std::mutex> lk(logMutex);
-                        logQueue.push(LogEntry{true, l.str()});
+                    const LatencyHistogram *hists[] = {&is.latency.render, &is.latency.upload,
+                                                       &is.latency.display, &is.latency.frame};
+                    for (const LatencyHistogram *h : hists) {
+                        l.printf(",%g,%g,%g,%g", h->percentileMs(0.50), h->percentileMs(0.95),
+                                 h->percentileMs(0.99), h->percentileMs(0.999));
                     }
-                    logCv.notify_one();
+                    l.printf("\n");
+                    std::memcpy(e.line, l.c_str(), l.len);
+                    e.len = static_cast<int>(l.len);
+                    pushLog(e);
                 }
-            } catch (...) {}
+            }
             // reset interval stats and clock
             for (auto &s : intervalStats) s.reset();
             summaryClock.restart();
@@ -983,22 +4653,48 @@ int main() {
 
         // only draw/display here if we didn't already in the timed block above
         if (!frameDisplayed) {
-            window.clear();
-            window.draw(sprite);
-            if (fontLoaded) window.draw(overlay);
-            window.display();
+            if (window) {
+                window->clear();
+                window->draw(sprite);
+                if (fontLoaded) window->draw(overlay);
+                window->draw(frameGraphBars);
+                window->display();
+            }
+            noteDisplayed();
+            if (frameStream.isOpen()) frameStream.push(*shownImage);
         }
 
         // Flush debounced save if enough idle time passed
-        if (viewDirty && saveClock.getElapsedTime().asSeconds() >= saveDebounceSec) {
-            double centerReal = (realMin + realMax) / 2.0;
-            double centerImag = (imagMin + imagMax) / 2.0;
-            double width = (realMax - realMin);
-            saveSettings(settingsPath, centerReal, centerImag, width, currentFractal);
+        if (viewDirty && !replaying && saveClock.getElapsedTime().asSeconds() >= saveDebounceSec) {
+            DD centerReal = fractalParams.originR + (realMin + realMax) / 2.0;
+            DD centerImag = fractalParams.originI + (imagMin + imagMax) / 2.0;
+            fileWriter.write(settingsPath, settingsText(centerReal, centerImag, realMax - realMin, imagMax - imagMin,
+                                                        currentFractal));
             viewDirty = false;
         }
         // Reset per-loop display flag
         frameDisplayed = false;
+
+        if (replaying) {
+            // the window's 60 Hz frame limit, emulated so background workers
+            // get the time they would have had interactively
+            const auto frameEnd = std::chrono::steady_clock::now();
+            replayStats.addFrame(std::chrono::duration<double, std::milli>(frameEnd - frameBegin).count());
+            if (!options.replayFast) {
+                std::this_thread::sleep_until(frameBegin + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                               std::chrono::duration<double>(REPLAY_STEP)));
+            }
+        }
+    }
+    if (recorder.isOpen()) recorder.end(loopNow);
+    if (replaying) {
+        const double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - loopStart).count();
+        replayStats.tileCacheMb = tileCachePtr ? options.tileCacheMb : 0;
+        replayStats.tileHits = tileCache.hits;
+        replayStats.tileMisses = tileCache.misses;
+        replayStats.report("C:/_AI/002/replay_results.csv", options.replayPath, loopNow, wallS, renderStats,
+                           fractalParams.originR + (realMin + realMax) / 2.0,
+                           fractalParams.originI + (imagMin + imagMax) / 2.0, realMax - realMin);
     }
     // Shutdown background writer thread cleanly
     try {
@@ -1011,12 +4707,18 @@ int main() {
     } catch (...) {}
     // Stop precache worker
     try { precache.stop(); } catch(...) {}
+    zoomCompletion.stop();
+    // Drain queued video frames before exit
+    frameStream.close();
+    std::cout.rdbuf(coutBuf);
     
     return 0;
 }
 
-// Settings file helpers — store center and width so aspect ratio is preserved
-bool loadSettings(const std::string &path, double &centerReal, double &centerImag, double &width, int &fractal) {
+// Settings file helpers — store center, width and height so aspect ratio is preserved.
+// The center is a double-double (hi + lo keys) so deep zooms survive a restart;
+// files without the lo/height keys still load.
+bool loadSettings(const std::string &path, DD &centerReal, DD &centerImag, double &width, double &height, int &fractal) {
     std::ifstream in(path);
     if (!in.is_open()) return false;
     std::string line;
@@ -1027,9 +4729,12 @@ bool loadSettings(const std::string &path, double &centerReal, double &centerIma
             std::string value;
             if (std::getline(iss, value)) {
                 try {
-                    if (key == "centerReal") centerReal = std::stod(value);
-                    else if (key == "centerImag") centerImag = std::stod(value);
+                    if (key == "centerReal") centerReal.hi = std::stod(value);
+                    else if (key == "centerRealLo") centerReal.lo = std::stod(value);
+                    else if (key == "centerImag") centerImag.hi = std::stod(value);
+                    else if (key == "centerImagLo") centerImag.lo = std::stod(value);
                     else if (key == "width") width = std::stod(value);
+                    else if (key == "height") height = std::stod(value);
                     else if (key == "fractal") fractal = std::stoi(value);
                 } catch (...) {
                     // ignore parse errors
@@ -1040,12 +4745,19 @@ bool loadSettings(const std::string &path, double &centerReal, double &centerIma
     return true;
 }
 
-bool saveSettings(const std::string &path, double centerReal, double centerImag, double width, int fractal) {
-    std::ofstream out(path, std::ios::trunc);
-    if (!out.is_open()) return false;
-    out << "centerReal=" << std::setprecision(15) << centerReal << "\n";
-    out << "centerImag=" << std::setprecision(15) << centerImag << "\n";
-    out << "width=" << std::setprecision(15) << width << "\n";
+bool saveSettings(const std::string &path, const DD &centerReal, const DD &centerImag, double width, double height, int fractal) {
+    return writeFileAtomic(path, settingsText(centerReal, centerImag, width, height, fractal));
+}
+
+std::string settingsText(const DD &centerReal, const DD &centerImag, double width, double height, int fractal) {
+    std::ostringstream out;
+    out << std::setprecision(17);
+    out << "centerReal=" << centerReal.hi << "\n";
+    out << "centerRealLo=" << centerReal.lo << "\n";
+    out << "centerImag=" << centerImag.hi << "\n";
+    out << "centerImagLo=" << centerImag.lo << "\n";
+    out << "width=" << width << "\n";
+    out << "height=" << height << "\n";
     out << "fractal=" << fractal << "\n";
-    return true;
+    return out.str();
 }